@@ -1,33 +1,106 @@
 #pragma once
 
-#include "order_book.hpp"
+#include "engine.hpp"
+#include "xoshiro.hpp"
 #include <thread>
 #include <atomic>
-#include <random>
+#include <memory>
+#include <vector>
+
+enum class FlowModel {
+    UNIFORM,    // Prices drawn uniformly from a fixed band, whatever the market does
+    MARKET      // Prices quoted around a random-walk mid with power-law depth from the touch
+};
+
+// Shape of the generated order flow. Every producer draws from its own
+// generator, so a fixed seed reproduces each producer's stream of orders.
+struct FlowConfig {
+    FlowModel model = FlowModel::UNIFORM;
+    uint64_t seed = 0;                  // 0 = seeded from random_device; producer i otherwise uses seed + i
+    bool poissonArrivals = false;       // Exponential gaps between orders at the paced rate; needs a rate
+    double cancelRatio = 0.0;           // Share of requests that cancel one of the producer's earlier orders
+
+    // MARKET model
+    double midVolatilityTicks = 1.0;    // Std dev of the mid's step per generated order
+    double midReversion = 0.01;         // Fraction of the gap to the last trade the mid closes per order
+    double depthExponent = 1.5;         // Power-law tail of a quote's distance behind the touch, in ticks
+    Price maxDepthTicks = 500;
+    double marketableRatio = 0.05;      // Limit orders priced through the mid instead of behind it
+};
+
+struct GeneratorConfig {
+    size_t producers = 1;           // Threads submitting orders through Engine::submitOrder
+    double ratePerSecond = 0.0;     // Across all producers; 0 = as fast as the engine accepts them
+    FlowConfig flow;
+};
 
 class BackgroundGenerator {
 public:
-    explicit BackgroundGenerator(OrderBook& orderBook);
+    explicit BackgroundGenerator(Engine& engine, const GeneratorConfig& config = GeneratorConfig{});
     ~BackgroundGenerator();
 
     void start();
     void stop();
 
+    const GeneratorConfig& getConfig() const;
+
+    // Orders generated and handed to the engine together
+    static constexpr size_t BATCH_SIZE = 256;
+
 private:
-    void tradeLoop();
-    Order generateRandomOrder();
+    // An order a producer may cancel later
+    struct OpenOrder {
+        int id;
+        int userId;
+        SymbolId symbol;
+    };
+
+    // One column of random bits per draw an order may need. A whole batch
+    // of columns is filled by the PRNG before any order is built from them.
+    enum Draw : size_t {
+        DRAW_CANCEL,
+        DRAW_PICK,
+        DRAW_USER,
+        DRAW_SYMBOL,
+        DRAW_TYPE,
+        DRAW_SIDE,
+        DRAW_QUANTITY,
+        DRAW_PRICE,
+        DRAW_MARKETABLE,
+        DRAW_STEP_RADIUS,
+        DRAW_STEP_ANGLE,
+        DRAW_TRIGGER,
+        DRAW_OFFSET,
+        DRAW_GAP,
+        DRAW_COUNT
+    };
+
+    // Each producer thread owns its random state and buffers, so producers
+    // share nothing but the engine's ingress ring
+    struct Producer {
+        Producer(uint64_t seed, size_t symbolCount);
+
+        Xoshiro256x4 rng;
+        alignas(64) uint64_t draws[DRAW_COUNT][BATCH_SIZE];
+        Order orders[BATCH_SIZE];
+        double gaps[BATCH_SIZE];            // Seconds before each order is due, when paced
+
+        std::vector<double> mids;           // MARKET model mid per symbol in ticks, 0 until first used
+        std::vector<OpenOrder> openOrders;  // Most recent orders, oldest overwritten first
+        size_t nextOpenOrder = 0;
+
+        std::thread thread;
+    };
+
+    void tradeLoop(Producer& producer);
+    void generateBatch(Producer& producer);
+    void buildOrder(Producer& producer, size_t i, Order& order, const std::vector<Price>& lastTrades);
+    bool buildCancel(Producer& producer, size_t i, Order& request);
+    Price quotePrice(const Producer& producer, size_t i, Side side, double mid) const;
+    void rememberOrder(Producer& producer, const Order& order);
 
-    OrderBook& orderBook;
+    Engine& engine;
+    GeneratorConfig config;
     std::atomic<bool> running;
-    std::thread bgThread;  
-    
-    // Random number generators
-    std::mt19937 rng;
-    std::uniform_real_distribution<double> priceDist;
-    std::uniform_real_distribution<double> qtyDist;
-    std::uniform_int_distribution<int> userIdDist;
-    std::uniform_int_distribution<int> sideDist;
-    std::uniform_int_distribution<int> typeDist;
-    
-    int orderId; 
+    std::vector<std::unique_ptr<Producer>> producers;
 };
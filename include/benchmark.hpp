@@ -1,40 +1,126 @@
 #pragma once
 
+#include "histogram.hpp"
+#include "mpsc_ring.hpp"
+#include "tsc_clock.hpp"
 #include <chrono>
 #include <string>
 #include <atomic>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <fstream>
 #include <unordered_map>
 #include <vector>
-#include <limits>
+
+// Every counter is registered here at compile time, so the hot path indexes an
+// array instead of hashing a name. Names for display live in benchmark.cpp.
+enum class Counter : uint16_t {
+    ORDERS_SUBMITTED,
+    USER_ORDERS_SUBMITTED,
+    BACKGROUND_ORDERS_GENERATED,
+    ORDERS_DISPATCHED,
+    ORDERS_PROCESSED,
+    ORDERS_MATCHED,
+    VOLUME_TRADED,
+    ORDERS_RESTING,
+    ORDERS_CANCELLED,
+    ORDERS_MODIFIED,
+    CANCELS_REJECTED,
+    MODIFIES_REJECTED,
+    ORDERS_REJECTED_UNKNOWN_SYMBOL,
+    ORDERS_REJECTED_INVALID,
+    STOP_ORDERS_PLACED,
+    STOP_ORDERS_TRIGGERED,
+    STOP_ORDERS_REJECTED,
+    ICEBERG_ORDERS_PLACED,
+    ICEBERG_ORDERS_REFILLED,
+    RESULTS_PUBLISHED,
+    REQUESTS_REJECTED,
+    SEQUENCE_ORDER_VIOLATIONS,
+    SNAPSHOTS_WRITTEN,
+    DEPTH_UPDATES,
+    DEPTH_UPDATES_DROPPED,
+    DEPTH_GAPS,
+    GATEWAY_REQUESTS,
+    GATEWAY_SESSIONS_REVOKED,
+    GATEWAY_RESPONSES_DROPPED,
+    EXECUTION_REPORTS,
+    EXECUTION_REPORTS_DROPPED,
+    COUNT
+};
+
+constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+// Timed operations, registered the same way as counters. SUBMIT_TO_DISPATCH
+// through MATCH_TO_PUBLISH are the consecutive stages of an order's trip
+// through the pipeline and add up to SUBMIT_TO_PUBLISH.
+enum class Timing : uint16_t {
+    ORDER_SUBMISSION,
+    SUBMIT_TO_DISPATCH,
+    DISPATCH_TO_PICKUP,
+    ORDER_PROCESSING,
+    MATCH_TO_PUBLISH,
+    SUBMIT_TO_PUBLISH,
+    ORDERBOOK_MATCH,
+    STOP_TRIGGER_CHECK,
+    BACKGROUND_ORDER_GENERATION,
+    SNAPSHOT_PAUSE,
+    SNAPSHOT_WRITE,
+    COUNT
+};
+
+constexpr size_t TIMING_COUNT = static_cast<size_t>(Timing::COUNT);
 
 class Benchmark {
 public:
     static Benchmark& getInstance();
+
+    // Each thread owns a cache-line aligned block of counter slots and one
+    // latency histogram per timer. Only the owning thread writes it, so
+    // recording is a plain load and store with no lock and no contention.
+    // Blocks are merged when stats are displayed or logged.
+    struct alignas(CACHE_LINE_SIZE) ThreadMetrics {
+        std::array<std::atomic<long>, COUNTER_COUNT> counters{};
+        std::array<LatencyHistogram, TIMING_COUNT> timings;
+    };
     
     class Timer {
     public:
-        Timer(const std::string& name);
+        explicit Timer(Timing id);
         ~Timer();
         
     private:
-        std::string timerName;
-        std::chrono::high_resolution_clock::time_point startTime;
+        Timing timing;
+        Ticks startTime;
     };
     
-    void startTimer(const std::string& name);
-    void endTimer(const std::string& name);
+    // Durations are TscClock ticks, converted to time only when reported
+    static void recordTiming(Timing id, Ticks duration) {
+        threadMetrics().timings[static_cast<size_t>(id)].record(duration);
+    }
     
-    void incrementCounter(const std::string& name);
-    void addToCounter(const std::string& name, long value);
+    static void incrementCounter(Counter id) { addToCounter(id, 1); }
+    static void addToCounter(Counter id, long value) {
+        std::atomic<long>& slot = threadMetrics().counters[static_cast<size_t>(id)];
+        slot.store(slot.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // Merged over every thread since the last reset; timings are in ticks
+    long getCounter(Counter id);
+    HistogramSnapshot getTiming(Timing id);
     
+    static const char* getTimingName(Timing id);
+    static const char* getCounterName(Counter id);
+
     void recordThroughput(const std::string& operation, int count, double durationMs);
     
     void displayRealTimeStats();
     void displayFinalReport();
     void logBenchmarks();
     
+    // Starts a new reporting interval: counters and histograms read zero
     void reset();
     void enableLogging(bool enable);
     
@@ -45,23 +131,23 @@ private:
     Benchmark(const Benchmark&) = delete;
     Benchmark& operator=(const Benchmark&) = delete;
     
-    struct TimingData {
-        std::chrono::high_resolution_clock::time_point startTime;
-        double totalTime = 0.0;
-        long count = 0;
-        double minTime = std::numeric_limits<double>::max();
-        double maxTime = 0.0;
-    };
-    
     struct ThroughputData {
         long totalOperations = 0;
         double totalTime = 0.0;
         double peakThroughput = 0.0;
         std::chrono::high_resolution_clock::time_point lastUpdate;
     };
-    
-    std::unordered_map<std::string, TimingData> timers;
-    std::unordered_map<std::string, std::atomic<long>> counters;
+
+    struct Totals {
+        std::array<long, COUNTER_COUNT> counters{};
+        std::array<HistogramSnapshot, TIMING_COUNT> timings{};
+    };
+
+    // Blocks outlive their threads so nothing recorded is lost; a block
+    // released by an exiting thread is handed to the next new one
+    std::vector<std::unique_ptr<ThreadMetrics>> threadBlocks;
+    std::vector<ThreadMetrics*> freeThreadBlocks;
+    Totals baseline;   // Merged totals at the last reset
     std::unordered_map<std::string, ThroughputData> throughputStats;
     
     std::mutex benchmarkMutex;
@@ -74,7 +160,31 @@ private:
     std::string formatDisplayName(const std::string& name);
     int getIndentLevel(const std::string& name);
     double getElapsedTimeMs(const std::chrono::high_resolution_clock::time_point& start);
+
+    ThreadMetrics* acquireThreadMetrics();
+    void releaseThreadMetrics(ThreadMetrics* metrics);
+    void mergeThreadMetrics(Totals& totals);   // Caller holds benchmarkMutex; totals since the last reset
+
+    static ThreadMetrics& threadMetrics() {
+        struct Handle {
+            ThreadMetrics* metrics = Benchmark::getInstance().acquireThreadMetrics();
+            ~Handle() { Benchmark::getInstance().releaseThreadMetrics(metrics); }
+        };
+        thread_local Handle handle;
+        return *handle.metrics;
+    }
 };
 
-#define BENCHMARK_TIMER(name) Benchmark::Timer timer(name)
-#define BENCHMARK_FUNCTION() Benchmark::Timer timer(__FUNCTION__)
+// Building with -DORDERBOOK_BENCHMARKS=OFF defines ORDERBOOK_NO_BENCHMARKS and
+// compiles every timer and counter below out of the hot paths
+#ifdef ORDERBOOK_NO_BENCHMARKS
+#define BENCHMARK_TIMER(id) ((void)0)
+#define BENCHMARK_TIMING(id, duration) ((void)sizeof(duration))   // Unevaluated
+#define BENCHMARK_COUNT(id) ((void)0)
+#define BENCHMARK_ADD(id, value) ((void)0)
+#else
+#define BENCHMARK_TIMER(id) Benchmark::Timer timer(id)
+#define BENCHMARK_TIMING(id, duration) Benchmark::recordTiming(id, duration)
+#define BENCHMARK_COUNT(id) Benchmark::incrementCounter(id)
+#define BENCHMARK_ADD(id, value) Benchmark::addToCounter(id, value)
+#endif
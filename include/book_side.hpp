@@ -0,0 +1,105 @@
+#pragma once
+
+#include "order.hpp"
+#include "order_pool.hpp"
+#include "occupancy_bitmap.hpp"
+#include <map>
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+enum class BookBackend {
+    MAP,
+    LADDER
+};
+
+#ifndef ORDERBOOK_DEFAULT_BACKEND
+#define ORDERBOOK_DEFAULT_BACKEND LADDER
+#endif
+
+struct BookConfig {
+    BookBackend backend = BookBackend::ORDERBOOK_DEFAULT_BACKEND;
+    size_t ladderLevels = 4096;  // Ticks covered by the dense ladder window
+    size_t poolChunkSize = 4096;       // Order nodes added each time the pool grows
+    size_t poolInitialCapacity = 65536; // Order nodes reserved up front
+    size_t depthSnapshotLevels = 256;   // Levels per side in each depth feed snapshot
+    size_t depthSnapshotInterval = 65536; // Depth records between periodic snapshots, 0 = only to resync
+};
+
+// One side (bids or asks) of the order book. With the LADDER backend, prices
+// inside a window of ticks live in a contiguous array of levels and an
+// occupancy bitmap gives the best level directly; prices outside the window
+// fall back to a std::map. With the MAP backend every level lives in the map.
+class BookSide {
+public:
+    using Level = OrderQueue;
+
+    BookSide(Side side, const BookConfig& config, Price center);
+
+    // Returns the level at `price`, creating it if needed
+    Level& level(Price price);
+
+    // Best (most aggressive) non-empty level, or nullptr if the side is empty
+    Level* best(Price& price);
+
+    // Drops an empty level so it no longer counts as the best price
+    void erase(Price price);
+
+    bool empty() const;
+
+    // Visits levels from best to worst. A visitor that returns bool stops
+    // the walk by returning false.
+    template <typename Visitor>
+    void forEachLevel(Visitor&& visit) const;
+
+private:
+    bool inWindow(Price price) const;
+    size_t slotFor(Price price) const;
+    Price priceAt(size_t slot) const;
+    bool better(Price a, Price b) const;
+    void recenter(Price center);
+
+    Side side;
+    bool useLadder;
+
+    Price base = 0;               // Lowest price covered by the ladder
+    size_t ladderCount = 0;       // Occupied ladder levels
+    std::vector<Level> ladder;
+    OccupancyBitmap occupied;
+
+    std::map<Price, Level> overflow;
+};
+
+template <typename Visitor>
+void BookSide::forEachLevel(Visitor&& visit) const {
+    bool stopped = false;
+    auto call = [&](Price price, const Level& level) {
+        if constexpr (std::is_same_v<std::invoke_result_t<Visitor&, Price, const Level&>, bool>) {
+            stopped = !visit(price, level);
+        } else {
+            visit(price, level);
+        }
+    };
+
+    // Overflow levels better than the window come first, then the window,
+    // then the overflow levels worse than the window.
+    Price top = base + static_cast<Price>(ladder.size());
+    auto low = useLadder ? overflow.lower_bound(base) : overflow.end();
+    auto high = useLadder ? overflow.lower_bound(top) : overflow.end();
+
+    auto visitLadder = [&]() {
+        for (size_t slot = occupied.findFirst(); slot != OccupancyBitmap::npos && !stopped; slot = occupied.findNext(slot + 1)) {
+            call(priceAt(slot), ladder[slot]);
+        }
+    };
+
+    if (side == Side::SELL) {
+        for (auto it = overflow.begin(); it != low && !stopped; ++it) call(it->first, it->second);
+        if (useLadder) visitLadder();
+        for (auto it = high; it != overflow.end() && !stopped; ++it) call(it->first, it->second);
+    } else {
+        for (auto it = overflow.rbegin(); it != std::make_reverse_iterator(high) && !stopped; ++it) call(it->first, it->second);
+        if (useLadder) visitLadder();
+        for (auto it = std::make_reverse_iterator(low); it != overflow.rend() && !stopped; ++it) call(it->first, it->second);
+    }
+}
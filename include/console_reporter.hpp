@@ -0,0 +1,34 @@
+#pragma once
+
+#include "engine.hpp"
+#include "execution_report.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Prints the execution reports of the console user's orders. Runs on its own
+// thread and reads the reports off the shards' rings, so a slow terminal
+// holds up nothing but this thread; the books only pay for a ring push.
+class ConsoleReporter {
+public:
+    explicit ConsoleReporter(Engine& engine);
+    ~ConsoleReporter();
+
+    ConsoleReporter(const ConsoleReporter&) = delete;
+    ConsoleReporter& operator=(const ConsoleReporter&) = delete;
+
+    void start();
+    void stop();
+
+    // The line printed for `report`, newline included
+    static std::string render(const ExecutionReport& report, const Instrument& instrument);
+
+private:
+    void run();
+
+    Engine& engine;
+    std::vector<ExecutionReport> batch;
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "instrument.hpp"
+#include "order.hpp"
+#include "seqlock.hpp"
+#include <cstdint>
+#include <map>
+
+// One record of a book's incremental L2 feed. A LEVEL record gives the new
+// total quantity resting at one price on one side; 0 means the level is
+// gone. A RESET record starts a depth snapshot: the consumer drops its view
+// of the book and the LEVEL records that follow rebuild it. A TRADE record
+// is one fill at `price` for `quantity`, `side` being the aggressor's; fills
+// come before the LEVEL record of the level they traded against. Sequence
+// numbers are per book and count every record the book produced, including
+// ones it had to drop because the ring was full, so a consumer sees every
+// loss as a gap. A lost TRADE is not recovered by the next snapshot.
+enum class DepthUpdateKind : uint8_t {
+    LEVEL,
+    RESET,
+    TRADE
+};
+
+struct DepthUpdate {
+    uint64_t sequence;
+    Price price;
+    Quantity quantity;
+    SymbolId symbol;
+    DepthUpdateKind kind;
+    Side side;
+};
+
+struct DepthLevel {
+    Price price;
+    Quantity quantity;
+};
+
+constexpr size_t DEPTH_VIEW_LEVELS = 20;   // Levels per side readers can see
+
+// Best levels of each side of one book, as last published by its DepthView
+struct DepthLevels {
+    uint64_t updates = 0;          // Records applied so far
+    uint64_t gaps = 0;             // Times the view fell behind and waited for a resync
+    uint32_t bidCount = 0;
+    uint32_t askCount = 0;
+    uint32_t synced = 0;           // 0 while waiting for a resync after a gap
+    DepthLevel bids[DEPTH_VIEW_LEVELS] = {};
+    DepthLevel asks[DEPTH_VIEW_LEVELS] = {};
+};
+
+// L2 view of one book rebuilt from its depth feed. Only the publish stage
+// applies records; any thread may read the published best levels, which are
+// copied out through a sequence lock after each batch of records.
+class DepthView {
+public:
+    // Publish stage only
+    void apply(const DepthUpdate& update);
+    void publish();
+
+    // Any thread
+    DepthLevels read() const;
+
+private:
+    std::map<Price, Quantity, std::greater<Price>> bids;
+    std::map<Price, Quantity> asks;
+    uint64_t nextSequence = 1;
+    bool synced = true;
+    bool changed = false;
+    DepthLevels levels;
+    SeqLock<DepthLevels> published;
+};
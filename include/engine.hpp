@@ -1,35 +1,136 @@
 #pragma once
 #include "order.hpp"
 #include "order_book.hpp"
-#include "thread_pool.hpp"
-#include <queue>
-#include <mutex>
-#include <condition_variable>
+#include "shard.hpp"
+#include "mpsc_ring.hpp"
+#include "spin_wait.hpp"
+#include "journal.hpp"
+#include "snapshot.hpp"
+#include "latency_trace.hpp"
+#include "depth_feed.hpp"
+#include "shm_feed.hpp"
+#include "gateway.hpp"
+#include <vector>
+#include <memory>
+#include <string>
 #include <atomic>
 #include <thread>
 
+struct EngineConfig {
+    std::vector<Instrument> instruments = {Instrument{}};  // One book per symbol
+    size_t shardCount = 1;                // Matching threads; symbols are spread round-robin
+    std::vector<int> cpuAffinity;         // CPU for each shard thread, missing entries are not pinned
+    size_t queueCapacity = 1 << 16;       // Size of the ingress ring and of every ring between stages
+    size_t dispatchBatchSize = 256;       // Items each stage drains per ring poll
+    WaitStrategy waitStrategy = WaitStrategy::SPIN_THEN_PARK;
+    unsigned spinIterations = 10000;      // Empty polls before an idle stage parks
+    BookConfig bookConfig;
+    JournalConfig journal;                // Journal every sequenced request when a path is set
+    SnapshotConfig snapshot;              // Snapshot every book when a path is set
+    TraceConfig trace;                    // Write sampled per-order stage latencies when a path is set
+    ShmFeedConfig marketDataFeed;         // Publish trades and book updates to shared memory when a name is set
+    GatewayConfig gateway;                // Accept orders from other processes when a name or socket path is set
+};
+
+struct RecoveryStats {
+    uint64_t snapshotSequence = 0;   // Sequence point of the loaded snapshot, 0 if none
+    size_t snapshotOrders = 0;       // Orders restored from it
+    double snapshotLoadMs = 0.0;
+    size_t requests = 0;             // Journaled requests replayed on top of the snapshot
+    double elapsedMs = 0.0;
+};
+
+// Orders flow through a fixed pipeline:
+//   ingress (MPSC ring) -> sequencer -> shard inbox (SPSC) -> matching
+//   -> result ring (SPSC) -> publish stage
+// The sequencer is a single thread that stamps every request with the next
+// sequence number, so each book sees its requests in one deterministic order
+// no matter how many threads submit.
 class Engine {
 public:
-    explicit Engine(size_t workerCount = 4);
+    explicit Engine(const EngineConfig& config = EngineConfig{});
 
     ~Engine();
 
+    // Rebuilds every book from the latest snapshot, if any, and then replays
+    // the journal past the snapshot's sequence point. Call once, before start().
+    bool recover(RecoveryStats& stats, std::string& error);
+
     void start();
     void stop();
     void submitOrder(const Order& order);
-    
-    OrderBook& getOrderBook();
+
+    // Queues `count` requests in as few ring operations as possible; they
+    // are sequenced in the order given
+    void submitOrders(const Order* orders, size_t count);
+
+    // Queued behind any orders already submitted, like a new order
+    void cancelOrder(int orderId, int userId = 0, SymbolId symbol = 0);
+    void modifyOrder(int orderId, Price newPrice, Quantity newQuantity, int userId = 0, SymbolId symbol = 0);
+
+    // Queues a snapshot of every book at the next sequence point. Returns
+    // false if snapshots are not configured.
+    bool requestSnapshot();
+    uint64_t getLastSnapshotSequence() const;
+
+    // Unique across every producer (UI, background generator, ...)
+    int nextOrderId();
+
+    // Reserves `count` consecutive ids and returns the first
+    int reserveOrderIds(int count);
+
+    // Only the shard thread matches on a book; other threads may read its
+    // atomics (last traded price) and instrument
+    OrderBook& getOrderBook(SymbolId symbol = 0);
+
+    // Best levels of a book as rebuilt from its depth feed by the publish
+    // stage; safe from any thread
+    DepthLevels getDepth(SymbolId symbol = 0) const;
+
+    // Execution reports of CONSOLE_USER_ID's orders from every shard. Single
+    // consumer: the console reporter thread.
+    size_t pollExecutions(ExecutionReport* out, size_t maxReports);
+
+    size_t getSymbolCount() const;
+    const Instrument& getInstrument(SymbolId symbol) const;
+    bool findSymbol(const std::string& name, SymbolId& symbol) const;
+
+    size_t getShardCount() const;
+    size_t getQueueDepth() const;
+
+    // Highest sequence number stamped so far / whose result has been published
+    uint64_t getSequencedCount() const;
+    uint64_t getPublishedSequence() const;
 
 private:
     void dispatchOrders();
+    void publishResults();
+    bool loadSnapshot(RecoveryStats& stats, std::string& error);
 
-    std::queue<Order> orderQueue;             
-    std::mutex queueMutex;                    
-    std::condition_variable cv;               
+    EngineConfig config;
+
+    MpscRing<Order> ingress;                  
+    Parker dispatcherParker;
+    Parker publisherParker;
     std::atomic<bool> running;                
+    std::atomic<bool> publishing;
+    std::atomic<int> orderIdCounter;
+    std::atomic<uint64_t> sequencedCount;
+    std::atomic<uint64_t> publishedSequence;
+    uint64_t lastSequence = 0;                  // Sequencer thread only once started
+
+    uint64_t layoutHash = 0;                    // Identifies the symbol set in journals and snapshots
+    std::unique_ptr<Journal> journal;
+    std::unique_ptr<SnapshotWriter> snapshotWriter;
+    std::unique_ptr<LatencyTrace> trace;        // Publisher thread only once started
+    std::unique_ptr<ShmPublisher> marketDataFeed;  // Publisher thread only once started
+    std::unique_ptr<Gateway> gateway;
 
-    ThreadPool pool;                            
-    OrderBook orderBook;                        
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<size_t> shardForSymbol;         // Shard index, indexed by SymbolId
+    std::vector<OrderBook*> books;              // Indexed by SymbolId
+    std::vector<std::unique_ptr<DepthView>> depthViews;  // Indexed by SymbolId, applied by the publisher
 
     std::thread dispatcherThread;               
+    std::thread publisherThread;
 };
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "order.hpp"
+#include "instrument.hpp"
+#include "mpsc_ring.hpp"
+#include <cstdint>
+
+// The interactive UI's user. Only this user's orders produce execution
+// reports on the report ring; gateway users get their fills through the
+// shard's results, and everyone else learns about executions from the logs
+// or the market data feed.
+constexpr int CONSOLE_USER_ID = 0;
+
+enum class ExecutionKind : uint8_t {
+    ACCEPTED,           // A STOP order is waiting for its trigger
+    FILLED,             // The order traded and nothing is left of it
+    PARTIALLY_FILLED,   // The order traded and some of it is left
+    RESTED,             // What was left of the order joined the book
+    TRIGGERED,          // A STOP order triggered and was released
+    REJECTED,
+    REFILLED,           // An ICEBERG slice filled and the next one is showing
+    CANCELLED,          // Cancelled by its owner, or the unfilled rest of a MARKET order
+    MODIFIED
+};
+
+enum class RejectReason : uint8_t {
+    NONE,
+    PRICE_COLLAR,       // A triggered STOP_LIMIT priced too far from the trade
+    UNKNOWN_ORDER,      // Cancel/modify of an order that isn't resting or isn't the user's
+    INVALID_QUANTITY,
+    INVALID_PRICE       // Modify of a priced order to a price of zero or less
+};
+
+// What happened to one order, written by the book's shard thread and
+// rendered elsewhere. A plain value, so handing it over costs one ring slot.
+struct ExecutionReport {
+    Price price;            // Trade price; otherwise the order's (new) limit price
+    Quantity quantity;      // Traded, resting or newly visible quantity
+    Quantity remaining;     // Left of the order afterwards; ICEBERG: hidden reserve included
+    Price reference;        // ACCEPTED: trigger price; TRIGGERED and PRICE_COLLAR: last trade
+    int32_t orderId;
+    int32_t userId;
+    OrderType type;
+    Side side;
+    OrderAction action;     // The request that caused it
+    SymbolId symbol;
+    ExecutionKind kind;
+    RejectReason reason;
+    bool maker;             // Fills: the order was resting
+    bool keptPriority;      // MODIFIED: amended in place rather than re-entered
+};
+
+static_assert(sizeof(ExecutionReport) <= CACHE_LINE_SIZE, "an execution report fits in a cache line");
+
+// One fill of an order owned outside the process. The book collects them
+// during a request and its shard publishes them after the request's result.
+struct Fill {
+    Price price;
+    Quantity quantity;
+    uint64_t clientTag;
+    int32_t orderId;
+    int32_t userId;
+    Side side;              // The filled order's side
+    bool maker;             // The filled order was resting
+};
+
+inline ExecutionReport makeExecutionReport(ExecutionKind kind, const Order& order) {
+    ExecutionReport report{};
+    report.kind = kind;
+    report.price = order.price;
+    report.quantity = order.quantity;
+    report.orderId = order.id;
+    report.userId = order.userId;
+    report.type = order.type;
+    report.side = order.side;
+    report.action = order.action;
+    return report;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "gateway_protocol.hpp"
+#include "order.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Engine;
+struct OrderResult;
+
+struct GatewayConfig {
+    std::string shmName;       // POSIX shared memory name, e.g. /orderbook_gw; empty = no shared memory entry
+    std::string socketPath;    // Unix domain socket path; empty = no socket entry
+};
+
+constexpr size_t GATEWAY_SOCKET_CLIENTS = 8;
+constexpr size_t GATEWAY_MAX_SESSIONS = GATEWAY_SHM_CLIENTS + GATEWAY_SOCKET_CLIENTS;
+
+// Order entry for other processes. Clients write fixed-size binary requests
+// into a ring in shared memory (or onto a Unix domain socket); the gateway
+// thread turns them into engine requests and submits them in batches. The
+// publish stage hands every result and fill to onResult/onFill, which
+// route acks and fills back to the session that sent the order by its
+// userId, so nothing on the request path parses text or takes a lock.
+class Gateway {
+public:
+    Gateway(const GatewayConfig& config, Engine& engine);
+    ~Gateway();
+
+    Gateway(const Gateway&) = delete;
+    Gateway& operator=(const Gateway&) = delete;
+
+    // Creates the segment and/or the listening socket. On failure returns
+    // false and describes why in `error`.
+    bool open(std::string& error);
+
+    void start();
+
+    // Stops reading requests and tells clients the gateway has gone; call
+    // before the engine drains its pipeline
+    void stop();
+
+    // Removes the segment and the socket; call once the publish stage has
+    // stopped routing responses
+    void close();
+
+    // Publisher thread only. A client that does not keep up with its
+    // responses loses them rather than stall the publisher.
+    void onResult(const OrderResult& result);
+    void onFill(const OrderResult& fill);
+
+private:
+    struct Session {
+        std::atomic<int32_t> userId{0};       // 0 = no session; read by the publisher to route
+        uint32_t generation = 0;
+        GatewayResponseRing* responses = nullptr;
+        std::atomic<uint64_t>* responsesDropped = nullptr;
+
+        // Socket sessions: responses are queued on a ring of their own and
+        // written out by the gateway thread
+        int fd = -1;
+        std::unique_ptr<GatewayResponseRing> socketResponses;
+        std::atomic<uint64_t> socketDropped{0};
+        std::vector<char> input;              // Start of a request not fully read yet
+        std::vector<char> output;             // Bytes of responses not fully written yet
+        size_t outputOffset = 0;
+    };
+
+    void run();
+    bool serviceShmSlots();
+    void acceptClients();
+    bool readSocket(Session& session);
+    bool flushSocket(Session& session);
+    void closeSocket(Session& session);
+    void reapDeadClients();
+
+    int32_t openSession(size_t index);
+    bool toOrder(const GatewayRequest& request, int32_t userId, Ticks now, Order& order);
+    void submitRequests(const GatewayRequest* requests, size_t count, Session& session, size_t index);
+    void respond(int32_t userId, const GatewayResponse& response);
+
+    GatewayConfig config;
+    Engine& engine;
+
+    size_t mappedSize = 0;
+    GatewaySegment* segment = nullptr;
+    int listenFd = -1;
+
+    Session sessions[GATEWAY_MAX_SESSIONS];   // Shared memory slots first, then sockets
+    std::vector<Order> batch;
+    std::vector<char> readBuffer;             // Socket bytes being split into requests
+    int nextOrderId = 0;                      // Ids reserved from the engine in blocks
+    int reservedEnd = 0;
+
+    std::atomic<bool> running{false};
+    std::thread thread;
+};
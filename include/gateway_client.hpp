@@ -0,0 +1,60 @@
+#pragma once
+
+#include "gateway_protocol.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One session with the order entry gateway, over shared memory or the Unix
+// domain socket. Neither send() nor poll() blocks, so one thread can keep
+// requests going out while it reads acks and fills as they come back.
+class GatewayClient {
+public:
+    GatewayClient() = default;
+    ~GatewayClient();
+
+    GatewayClient(const GatewayClient&) = delete;
+    GatewayClient& operator=(const GatewayClient&) = delete;
+
+    // Claims a client slot and waits up to `timeoutSeconds` for the gateway
+    // to open the session. On failure returns false and describes why in `error`.
+    bool connectShm(const std::string& name, std::string& error, double timeoutSeconds = 5.0);
+    bool connectSocket(const std::string& path, std::string& error, double timeoutSeconds = 5.0);
+
+    // Queues as many of `count` requests as there is room for and returns how
+    // many; 0 means the gateway is behind, or the session has ended
+    size_t send(const GatewayRequest* requests, size_t count);
+
+    // Copies up to `maxResponses` responses into `out` and returns how many
+    size_t poll(GatewayResponse* out, size_t maxResponses);
+
+    // False once the gateway has shut down or ended the session and every
+    // response it sent has been read
+    bool isConnected() const { return connected; }
+
+    void disconnect();
+
+    int32_t getUserId() const { return userId; }
+    uint32_t getSymbolCount() const { return symbolCount; }
+
+    // Responses the gateway discarded because this client read too slowly
+    uint64_t getResponsesDropped() const;
+
+private:
+    size_t pollSocket(GatewayResponse* out, size_t maxResponses);
+    bool flushSocket();
+
+    size_t mappedSize = 0;
+    GatewaySegment* segment = nullptr;
+    GatewaySlot* slot = nullptr;
+
+    int fd = -1;
+    std::vector<char> input;      // Start of a response not fully read yet
+    std::vector<char> output;     // Rest of a request the socket only took part of
+    std::vector<char> readBuffer;
+
+    int32_t userId = 0;
+    uint32_t symbolCount = 0;
+    bool connected = false;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "instrument.hpp"
+#include "mpsc_ring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Binary order entry protocol shared by the gateway and its clients. Every
+// message is a fixed-size struct, sent as is over shared memory or a Unix
+// domain socket; enums travel as single bytes holding the engine's values.
+
+struct GatewayRequest {
+    uint64_t clientTag;          // Echoed in the response and in fills of the order
+    Price price;
+    Quantity quantity;           // ICEBERG: total size
+    Price triggerPrice;          // STOP orders
+    Quantity displayQuantity;    // ICEBERG: visible slice
+    int32_t orderId;             // CANCEL/MODIFY: the engine id from the ack
+    SymbolId symbol;
+    uint8_t action;              // OrderAction: NEW, CANCEL or MODIFY
+    uint8_t type;                // OrderType
+    uint8_t side;                // Side
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(GatewayRequest) == 56, "request layout is part of the protocol");
+
+enum class GatewayResponseKind : uint8_t {
+    SESSION,     // First message of a socket session; carries the session's userId
+    ACCEPTED,    // The request was sequenced and applied
+    REJECTED,    // The request was invalid, or a cancel/modify found no order
+    FILL         // An order of this session traded; always after the ack of the request that traded
+};
+
+struct GatewayResponse {
+    uint64_t clientTag;
+    uint64_t sequence;           // Engine sequence of the request; FILL: of the request that traded; 0 for SESSION
+    Price price;                 // FILL: trade price
+    Quantity quantity;           // FILL: traded quantity; SESSION: number of symbols
+    int32_t orderId;
+    int32_t userId;              // Session the response belongs to
+    SymbolId symbol;
+    GatewayResponseKind kind;
+    uint8_t action;              // ACCEPTED/REJECTED: the request's OrderAction
+    uint8_t side;                // FILL: this order's side
+    uint8_t maker;               // FILL: 1 if this order was resting
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(GatewayResponse) == 48, "response layout is part of the protocol");
+
+// Sessions are told apart by userId. The gateway hands out ids from this
+// base upward, clear of the UI (0) and the background generator.
+constexpr int32_t GATEWAY_USER_BASE = 1000000;
+
+// SPSC ring that can live in shared memory: no pointers, all-zero bytes are
+// an empty ring, and only the two positions are shared between the sides.
+// The producer owns writePos and the consumer readPos.
+template <typename T, size_t CAPACITY>
+struct SharedRing {
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+
+    // Producer only. Pushes as many of `count` items as fit and returns how many.
+    size_t tryPushBatch(const T* items, size_t count) {
+        uint64_t tail = writePos.load(std::memory_order_relaxed);
+        uint64_t space = CAPACITY - (tail - readPos.load(std::memory_order_acquire));
+        count = std::min<uint64_t>(count, space);
+        for (size_t i = 0; i < count; ++i) {
+            slots[(tail + i) & (CAPACITY - 1)] = items[i];
+        }
+        if (count > 0) {
+            writePos.store(tail + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool tryPush(const T& item) {
+        return tryPushBatch(&item, 1) == 1;
+    }
+
+    // Consumer only
+    size_t tryPopBatch(T* out, size_t maxItems) {
+        uint64_t head = readPos.load(std::memory_order_relaxed);
+        uint64_t available = writePos.load(std::memory_order_acquire) - head;
+        size_t count = std::min<uint64_t>(available, maxItems);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = slots[(head + i) & (CAPACITY - 1)];
+        }
+        if (count > 0) {
+            readPos.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return readPos.load(std::memory_order_relaxed) == writePos.load(std::memory_order_acquire);
+    }
+
+    // Consumer only: discards whatever an earlier session left behind
+    void skipAll() {
+        readPos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writePos;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> readPos;
+    alignas(CACHE_LINE_SIZE) T slots[CAPACITY];
+};
+
+constexpr size_t GATEWAY_SHM_CLIENTS = 8;
+constexpr size_t GATEWAY_REQUEST_CAPACITY = 1 << 13;
+constexpr size_t GATEWAY_RESPONSE_CAPACITY = 1 << 14;
+
+using GatewayRequestRing = SharedRing<GatewayRequest, GATEWAY_REQUEST_CAPACITY>;
+using GatewayResponseRing = SharedRing<GatewayResponse, GATEWAY_RESPONSE_CAPACITY>;
+
+// A shared memory client slot. A client claims a FREE slot and waits for the
+// gateway to make it ACTIVE and fill in its userId; it sets CLOSING when it
+// leaves, and the gateway frees the slot once the requests are drained. A
+// client that sends a malformed request is REVOKED: the gateway ignores the
+// slot until the client disconnects. The gateway also frees slots whose
+// process has died.
+enum class GatewaySlotState : uint32_t {
+    FREE,
+    CLAIMED,
+    ACTIVE,
+    CLOSING,
+    REVOKED
+};
+
+struct GatewaySlot {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> state;
+    std::atomic<int32_t> pid;                 // Client process, written after the claim
+    std::atomic<int32_t> userId;              // Written by the gateway before ACTIVE
+    std::atomic<uint64_t> responsesDropped;   // Responses lost because the client fell behind
+    GatewayRequestRing requests;              // Client -> gateway
+    GatewayResponseRing responses;            // Gateway -> client
+};
+
+struct GatewaySegment {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t symbolCount;
+    std::atomic<uint32_t> running;            // Cleared when the gateway shuts down
+    GatewaySlot slots[GATEWAY_SHM_CLIENTS];
+};
+
+constexpr uint64_t GATEWAY_MAGIC = 0x3157474F424F00ULL;  // "\0OBOGW1"
+constexpr uint32_t GATEWAY_VERSION = 1;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Log-linear bucketing in the style of HDR histograms: every power of two is
+// split into SUB_BUCKETS linear buckets, so a recorded value is off by at most
+// 1/SUB_BUCKETS (about 3%) whatever its magnitude. Values are clock ticks.
+namespace histogram {
+
+constexpr unsigned SUB_BUCKET_BITS = 5;
+constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+constexpr unsigned MAX_EXPONENT = 44;   // Minutes even at several GHz; anything longer lands in the last bucket
+constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+inline unsigned highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+inline size_t bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS)
+        return static_cast<size_t>(value);
+
+    unsigned exponent = highestBit(value);
+    if (exponent > MAX_EXPONENT)
+        return BUCKET_COUNT - 1;
+
+    size_t sub = static_cast<size_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+// Highest value that lands in `bucket`, the value reported for it
+uint64_t bucketUpperBound(size_t bucket);
+
+}  // namespace histogram
+
+// Plain copy of one or more histograms, used for merging and reporting
+struct HistogramSnapshot {
+    std::array<uint64_t, histogram::BUCKET_COUNT> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    void add(const HistogramSnapshot& other);
+    void subtract(const HistogramSnapshot& other);
+
+    // `quantile` in [0, 1]; returns 0 for an empty histogram
+    uint64_t valueAt(double quantile) const;
+    uint64_t min() const;
+    uint64_t max() const;
+    double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// Recording side. Only the owning thread records, so every update is a
+// relaxed load and store; any thread may read it into a snapshot meanwhile.
+class LatencyHistogram {
+public:
+    void record(uint64_t value) {
+        bump(buckets[histogram::bucketFor(value)], 1);
+        bump(sum, value);
+        // Published last so a reader that sees the count also sees the bucket
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void addTo(HistogramSnapshot& snapshot) const;
+
+private:
+    static void bump(std::atomic<uint64_t>& cell, uint64_t value) {
+        cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, histogram::BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+};
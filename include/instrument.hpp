@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+// Prices are stored as an integer number of ticks and quantities as an
+// integer number of lots. Decimal values only exist at the edges (UI input,
+// console output and CSV logs).
+using Price = std::int64_t;
+using Quantity = std::int64_t;
+
+// Index of an instrument in the engine's symbol list
+using SymbolId = std::uint16_t;
+
+struct Instrument {
+    std::string symbol = "SIM";
+    double tickSize = 0.01;
+    double lotSize = 0.01;
+    double referencePrice = 100.0;  // Initial last traded price
+
+    Price toTicks(double price) const {
+        return static_cast<Price>(std::llround(price / tickSize));
+    }
+
+    Quantity toLots(double quantity) const {
+        return static_cast<Quantity>(std::llround(quantity / lotSize));
+    }
+
+    double toPrice(Price ticks) const {
+        return static_cast<double>(ticks) * tickSize;
+    }
+
+    double toQuantity(Quantity lots) const {
+        return static_cast<double>(lots) * lotSize;
+    }
+};
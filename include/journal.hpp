@@ -0,0 +1,98 @@
+#pragma once
+
+#include "order.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+enum class JournalSync {
+    NONE,        // Leave write-back to the OS: survives a process crash, not a power loss
+    PERIODIC,    // msync at most every syncIntervalMs
+    PER_BATCH    // msync every sequenced batch before it reaches the books
+};
+
+struct JournalConfig {
+    std::string path;                     // Empty = no journal
+    JournalSync sync = JournalSync::PERIODIC;
+    unsigned syncIntervalMs = 100;
+    size_t growBytes = 64 << 20;          // File is extended and remapped in steps of this size
+};
+
+// One request as the sequencer handed it to the books
+struct JournalRecord {
+    uint64_t sequence;
+    Price price;
+    Quantity quantity;
+    Price triggerPrice;
+    Quantity totalQuantity;
+    Quantity displayQuantity;
+    int32_t orderId;
+    int32_t userId;
+    SymbolId symbol;
+    uint8_t action;
+    uint8_t type;
+    uint8_t side;
+    uint8_t reserved[3];
+    uint32_t checksum;   // Over every byte before it; a torn tail record fails it
+};
+
+// Append-only, memory-mapped journal of every request the sequencer accepts.
+// Written by the sequencer thread only. Records sit back to back after a
+// small header; the file is zero-extended ahead of the writer, so the first
+// record that is all zeros or fails its checksum marks the end.
+class Journal {
+public:
+    // `layoutHash` identifies the symbol set; a journal written for a
+    // different one is refused on open
+    Journal(const JournalConfig& config, uint64_t layoutHash);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Creates the file or maps an existing one and finds its end. On failure
+    // returns false and describes why in `error`.
+    bool open(std::string& error);
+
+    // Calls apply(order) for every record already in the journal, in order
+    template <typename Apply>
+    size_t replay(Apply apply) const {
+        size_t count = 0;
+        for (size_t offset = dataOffset(); offset < writeOffset; offset += sizeof(JournalRecord)) {
+            apply(toOrder(*reinterpret_cast<const JournalRecord*>(base + offset)));
+            ++count;
+        }
+        return count;
+    }
+
+    void append(const Order& order);
+
+    // Marks the end of a sequenced batch and applies the sync policy
+    void commit();
+    void close();
+
+    uint64_t getLastSequence() const { return lastSequence; }
+    int getMaxOrderId() const { return maxOrderId; }
+    size_t getRecordCount() const;
+
+private:
+    static size_t dataOffset();
+    static Order toOrder(const JournalRecord& record);
+    static uint32_t checksumOf(const JournalRecord& record);
+
+    bool mapFile(size_t size, std::string& error);
+    void sync();
+
+    JournalConfig config;
+    uint64_t layoutHash;
+
+    int fd = -1;
+    char* base = nullptr;
+    size_t mappedSize = 0;
+    size_t writeOffset = 0;
+    size_t syncedOffset = 0;
+    uint64_t lastSequence = 0;
+    int maxOrderId = 0;
+    std::chrono::steady_clock::time_point lastSync;
+};
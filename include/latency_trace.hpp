@@ -0,0 +1,33 @@
+#pragma once
+
+#include "shard.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+struct TraceConfig {
+    std::string path;               // Empty = no trace
+    uint64_t sampleEvery = 1000;    // Trace one request in N, picked by sequence number
+};
+
+// Per-order stage latencies for a sample of requests, written as CSV by the
+// publish stage. Sampling by sequence number keeps the choice deterministic
+// and the file small enough to leave on.
+class LatencyTrace {
+public:
+    explicit LatencyTrace(const TraceConfig& config);
+
+    bool isOpen() const { return file.is_open(); }
+
+    bool sampled(uint64_t sequence) const {
+        return config.sampleEvery > 0 && sequence % config.sampleEvery == 0;
+    }
+
+    // `published` is when the publish stage picked the result up
+    void write(const OrderResult& result, Ticks published);
+    void flush();
+
+private:
+    TraceConfig config;
+    std::ofstream file;
+};
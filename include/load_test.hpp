@@ -0,0 +1,42 @@
+#pragma once
+
+#include "engine.hpp"
+#include "background_generator.hpp"
+#include "benchmark.hpp"
+#include <string>
+#include <vector>
+
+struct LoadTestConfig {
+    double durationSeconds = 10.0;
+    unsigned sampleIntervalMs = 100;           // How often queue depth is sampled
+    std::string reportPath = "logs/load_test.json";
+};
+
+struct LoadTestReport {
+    double elapsedSeconds = 0.0;               // Generation, not counting the drain at the end
+    double drainSeconds = 0.0;                 // From the producers stopping to the last result
+    long ordersSubmitted = 0;
+    uint64_t requestsPublished = 0;
+    size_t maxQueueDepth = 0;
+    double meanQueueDepth = 0.0;
+    std::vector<std::pair<Timing, HistogramSnapshot>> latencies;
+};
+
+// Runs the background generator against a started engine for a fixed time
+// with no UI, then stops the engine, which publishes every request already
+// submitted, and reports sustained throughput, latency percentiles and queue
+// depth
+class LoadTest {
+public:
+    LoadTest(Engine& engine, BackgroundGenerator& generator, const LoadTestConfig& config);
+
+    LoadTestReport run();
+
+    void print(const LoadTestReport& report) const;
+    bool writeJson(const LoadTestReport& report) const;
+
+private:
+    Engine& engine;
+    BackgroundGenerator& generator;
+    LoadTestConfig config;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "order.hpp"
+#include "instrument.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Fixed-size records shared by the binary logger and the offline decoder.
+// A binary log is a sequence of 64-byte records: every run starts a segment
+// (SEGMENT, then one INSTRUMENT record per symbol) followed by ORDER and
+// MATCH records. Prices and quantities stay in ticks/lots; the instrument
+// records carry what the decoder needs to turn them back into the CSV logs.
+
+enum class LogRecordKind : uint8_t {
+    INVALID = 0,
+    SEGMENT = 1,
+    INSTRUMENT = 2,
+    ORDER = 3,
+    MATCH = 4
+};
+
+enum class LogStatus : uint8_t {
+    SUBMITTED,
+    RESTING,
+    CANCELLED,
+    MODIFIED
+};
+
+constexpr uint32_t LOG_SEGMENT_MAGIC = 0x4F424C47;  // "OBLG"
+constexpr uint8_t LOG_FORMAT_VERSION = 1;
+constexpr size_t LOG_RECORD_SIZE = 64;
+
+struct LogRecord {
+    LogRecordKind kind;
+    LogStatus status;       // ORDER only
+    uint8_t orderType;
+    uint8_t side;
+    uint8_t restingSide;    // MATCH only
+    uint8_t reserved;
+    SymbolId symbol;
+    int64_t timestampNs;    // Wall clock, nanoseconds since the epoch
+    int32_t orderId;        // Incoming order id for MATCH
+    int32_t otherId;        // User id for ORDER, resting order id for MATCH
+    int64_t price;          // Match price for MATCH
+    int64_t quantity;       // Match quantity for MATCH
+    int64_t triggerPrice;
+    int64_t totalQuantity;
+    int64_t displayQuantity;
+};
+
+struct LogSegmentRecord {
+    LogRecordKind kind;
+    uint8_t version;
+    uint16_t instrumentCount;
+    uint32_t magic;
+    int64_t startNs;
+    uint8_t reserved[48];
+};
+
+struct LogInstrumentRecord {
+    LogRecordKind kind;
+    uint8_t reserved;
+    SymbolId symbol;
+    uint32_t nameLength;
+    double tickSize;
+    double lotSize;
+    char name[40];
+};
+
+static_assert(sizeof(LogRecord) == LOG_RECORD_SIZE, "log records must stay 64 bytes");
+static_assert(sizeof(LogSegmentRecord) == LOG_RECORD_SIZE, "log records must stay 64 bytes");
+static_assert(sizeof(LogInstrumentRecord) == LOG_RECORD_SIZE, "log records must stay 64 bytes");
+
+int64_t logClockNow();
+
+LogRecord makeOrderRecord(const Order& order, LogStatus status);
+LogRecord makeMatchRecord(const Order& incomingOrder, const Order& restingOrder, Price matchPrice, Quantity matchQuantity);
+LogSegmentRecord makeSegmentRecord(uint16_t instrumentCount);
+LogInstrumentRecord makeInstrumentRecord(SymbolId symbol, const Instrument& instrument);
+Instrument instrumentFromRecord(const LogInstrumentRecord& record);
+
+// CSV rendering used for orders.log / matches.log, whether written live or decoded
+extern const char* const ORDERS_CSV_HEADER;
+extern const char* const MATCHES_CSV_HEADER;
+
+std::string formatLogTimestamp(int64_t timestampNs);
+void writeOrderCsv(std::ostream& os, const LogRecord& record, const Instrument& instrument);
+void writeMatchCsv(std::ostream& os, const LogRecord& record, const Instrument& instrument);
@@ -1,20 +1,42 @@
 #pragma once
 
 #include "order.hpp"
+#include "instrument.hpp"
+#include "log_record.hpp"
+#include "spsc_ring.hpp"
 #include <string>
 #include <fstream>
 #include <mutex>
-#include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+enum class LogFormat {
+    TEXT,    // CSV written and flushed by the calling thread
+    BINARY   // Fixed-size records handed to a background writer
+};
 
 class Logger {
 public:
     static Logger& getInstance();
     
-    void logOrder(const Order& order);
-    void logMatch(const Order& incomingOrder, const Order& restingOrder, double matchPrice, double matchQuantity);
-    void logRestingOrder(const Order& order);
+    void logOrder(const Order& order, const Instrument& instrument);
+    void logMatch(const Order& incomingOrder, const Order& restingOrder, Price matchPrice, Quantity matchQuantity, const Instrument& instrument);
+    void logRestingOrder(const Order& order, const Instrument& instrument);
+    void logCancelledOrder(const Order& order, const Instrument& instrument);
+    void logModifiedOrder(const Order& order, const Instrument& instrument);
+
+    // Switches to binary logging. Must be called before any thread logs.
+    // Each logging thread gets its own SPSC ring of records; a writer thread
+    // drains them to `path`, which is turned back into CSV by OrderLogDecoder.
+    void startBinary(const std::vector<Instrument>& instruments, const std::string& path = "logs/events.bin");
+
+    // Drains the rings and stops the writer. Logging threads must be done.
+    void shutdown();
+
+    // While disabled every log call is dropped, e.g. during journal replay
+    void setEnabled(bool enable);
     
 private:
     Logger();
@@ -24,9 +46,24 @@ private:
     Logger& operator=(const Logger&) = delete;
     
     void ensureLogsDirectory();
-    std::string getCurrentTimestamp();
+    void openTextFiles();
+    void append(const LogRecord& record, const Instrument& instrument);
+    SpscRing<LogRecord>& threadRing();
+    size_t drainRings(std::vector<SpscRing<LogRecord>*>& active, std::vector<LogRecord>& batch);
+    void writerLoop();
     
+    LogFormat format = LogFormat::TEXT;
+    std::atomic<bool> enabled{true};
+
     std::ofstream ordersFile;
     std::ofstream matchesFile;
+    std::once_flag textFilesOpened;
     std::mutex logMutex;
+
+    std::ofstream binaryFile;
+    std::vector<std::unique_ptr<SpscRing<LogRecord>>> rings;  // One per logging thread
+    std::mutex ringsMutex;
+    std::atomic<size_t> ringCount{0};
+    std::atomic<bool> writerRunning{false};
+    std::thread writerThread;
 };
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "instrument.hpp"
+#include <cstdint>
+
+// Top of book and session statistics for one symbol, as published by its
+// book after every change. A side with nothing resting has size 0 and price
+// 0; high, low and VWAP are 0 until the first trade. Prices are in ticks and
+// quantities in lots, VWAP in (fractional) ticks.
+struct MarketData {
+    Price bestBid = 0;
+    Quantity bidSize = 0;
+    Price bestAsk = 0;
+    Quantity askSize = 0;
+
+    Price lastTrade = 0;
+    Quantity lastTradeSize = 0;
+    Price high = 0;
+    Price low = 0;
+    double vwap = 0.0;
+    Quantity volume = 0;           // Lots traded this session
+    uint64_t trades = 0;           // Fills this session
+    uint64_t updates = 0;          // Publications so far; changes on every update
+
+    bool hasBid() const { return bidSize > 0; }
+    bool hasAsk() const { return askSize > 0; }
+};
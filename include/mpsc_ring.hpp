@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded multi-producer / single-consumer ring. Each cell carries a
+// sequence number that says whether it is free for the producer claiming
+// that position or holds an item for the consumer (Vyukov's bounded queue).
+// Producers claim positions with one CAS; the consumer never writes shared
+// state except the cell sequence it releases. Cells and the two position
+// counters each sit on their own cache lines to avoid false sharing.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Returns false if the ring is full
+    bool tryPush(const T& item) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Claims a run of consecutive positions with one CAS and fills them.
+    // Pushes up to `count` items, fewer if the ring is nearly full, and
+    // returns how many; 0 means the ring is full.
+    size_t tryPushBatch(const T* items, size_t count) {
+        if (count > mask + 1) {
+            count = mask + 1;
+        }
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (count > 0) {
+            // The consumer frees cells in order, so if the last cell of the
+            // run is free for this lap, every cell before it is too
+            Cell& last = cells[(pos + count - 1) & mask];
+            size_t sequence = last.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + count - 1);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    for (size_t i = 0; i < count; ++i) {
+                        Cell& cell = cells[(pos + i) & mask];
+                        cell.value = items[i];
+                        cell.sequence.store(pos + i + 1, std::memory_order_release);
+                    }
+                    return count;
+                }
+            } else if (diff < 0) {
+                count /= 2;   // Not enough room for the whole run; try a shorter one
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        return 0;
+    }
+
+    // Single consumer only. Moves up to `maxItems` ready items into `out`.
+    size_t tryPopBatch(T* out, size_t maxItems) {
+        size_t count = 0;
+        while (count < maxItems) {
+            Cell& cell = cells[dequeuePos & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence != dequeuePos + 1) {
+                break;
+            }
+            out[count++] = cell.value;
+            cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+        }
+        return count;
+    }
+
+    // Single consumer only
+    bool empty() const {
+        return cells[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Approximate number of queued items, safe to call from any thread
+    size_t sizeApprox() const {
+        size_t head = dequeueSnapshot.load(std::memory_order_relaxed);
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    // Consumer publishes its position for sizeApprox() readers
+    void publishConsumerPosition() {
+        dequeueSnapshot.store(dequeuePos, std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos{0};
+    alignas(CACHE_LINE_SIZE) size_t dequeuePos = 0;
+    std::atomic<size_t> dequeueSnapshot{0};
+};
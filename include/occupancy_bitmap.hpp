@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Two-level bitmap over a fixed number of slots. The summary word tracks
+// which leaf words are non-zero, so finding the first set slot costs one
+// count-trailing-zeros per level instead of a scan.
+class OccupancyBitmap {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit OccupancyBitmap(size_t slots = 0)
+        : leaves((slots + 63) / 64, 0),
+          summary((leaves.size() + 63) / 64, 0) {
+    }
+
+    void set(size_t slot) {
+        size_t word = slot >> 6;
+        leaves[word] |= bit(slot);
+        summary[word >> 6] |= bit(word);
+    }
+
+    void clear(size_t slot) {
+        size_t word = slot >> 6;
+        leaves[word] &= ~bit(slot);
+        if (leaves[word] == 0) {
+            summary[word >> 6] &= ~bit(word);
+        }
+    }
+
+    bool test(size_t slot) const {
+        return (leaves[slot >> 6] & bit(slot)) != 0;
+    }
+
+    size_t findFirst() const {
+        for (size_t s = 0; s < summary.size(); ++s) {
+            if (summary[s] != 0) {
+                size_t word = (s << 6) + countTrailingZeros(summary[s]);
+                return (word << 6) + countTrailingZeros(leaves[word]);
+            }
+        }
+        return npos;
+    }
+
+    // First set slot at or after `from`
+    size_t findNext(size_t from) const {
+        size_t word = from >> 6;
+        if (word >= leaves.size()) {
+            return npos;
+        }
+
+        uint64_t bits = leaves[word] & (~uint64_t{0} << (from & 63));
+        if (bits != 0) {
+            return (word << 6) + countTrailingZeros(bits);
+        }
+
+        size_t next = word + 1;
+        size_t s = next >> 6;
+        if (s >= summary.size()) {
+            return npos;
+        }
+
+        uint64_t words = (next & 63) ? (summary[s] & (~uint64_t{0} << (next & 63))) : summary[s];
+        while (true) {
+            if (words != 0) {
+                size_t found = (s << 6) + countTrailingZeros(words);
+                return (found << 6) + countTrailingZeros(leaves[found]);
+            }
+            if (++s >= summary.size()) {
+                return npos;
+            }
+            words = summary[s];
+        }
+    }
+
+private:
+    static uint64_t bit(size_t index) {
+        return uint64_t{1} << (index & 63);
+    }
+
+    static unsigned countTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    std::vector<uint64_t> leaves;
+    std::vector<uint64_t> summary;
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "instrument.hpp"
+#include "tsc_clock.hpp"
 #include <chrono> 
 #include <iostream>
 #include <string>
@@ -17,17 +19,46 @@ enum class Side {
     SELL
 };
 
+// What a request submitted to the engine asks the book to do. CANCEL only
+// uses id/userId; MODIFY also carries the new price and quantity. SNAPSHOT
+// is broadcast to every shard by the sequencer and asks each one to copy its
+// books at that sequence point.
+enum class OrderAction {
+    NEW,
+    CANCEL,
+    MODIFY,
+    SNAPSHOT
+};
+
+// When an order reached each pipeline stage, as tick offsets from
+// Order::timestamp. Offsets are full width: 2^32 ticks is only a couple of
+// seconds, which an order can spend queued behind a backlog under load.
+struct OrderStages {
+    Ticks dispatched = 0;   // Sequencer took it off the ingress ring
+    Ticks pickedUp = 0;     // Its shard started processing it
+    Ticks matched = 0;      // Its shard finished processing it
+
+    static Ticks offset(Ticks submitted, Ticks at) {
+        return TscClock::elapsed(submitted, at);
+    }
+};
+
 struct Order {
     int id;
     int userId;
     OrderType type;
     Side side;
-    double price;
-    double quantity;
-    double triggerPrice = 0.0;
-    double totalQuantity = 0.0;
-    double displayQuantity = 0.0;
-    std::chrono::high_resolution_clock::time_point timestamp;
+    Price price;
+    Quantity quantity;
+    Price triggerPrice = 0;
+    Quantity totalQuantity = 0;
+    Quantity displayQuantity = 0;
+    Ticks timestamp = 0;    // TscClock reading at submission
+    OrderAction action = OrderAction::NEW;
+    SymbolId symbol = 0;
+    uint64_t sequence = 0;  // Stamped by the engine's sequencer; the order every book sees requests in
+    OrderStages stages{};
+    uint64_t clientTag = 0; // Opaque to the engine; echoed to gateway clients in acks and fills
 
     friend std::ostream& operator<<(std::ostream& os, const Order& order) {
         os << "Order{id: " << order.id
@@ -55,7 +86,7 @@ struct Order {
                << ", displayQuantity: " << order.displayQuantity;
         }
         
-        os << ", timestamp: " << std::chrono::duration_cast<std::chrono::milliseconds>(order.timestamp.time_since_epoch()).count()
+        os << ", timestamp: " << order.timestamp
            << '}';
         return os;
     }    
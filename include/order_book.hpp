@@ -1,39 +1,138 @@
 #pragma once
 
 #include "order.hpp"
+#include "instrument.hpp"
+#include "book_side.hpp"
+#include "order_pool.hpp"
+#include "order_index.hpp"
+#include "market_data.hpp"
+#include "seqlock.hpp"
+#include "depth_feed.hpp"
+#include "execution_report.hpp"
+#include "spsc_ring.hpp"
 #include <map>
-#include <mutex>
-#include <deque>
+#include <vector>
 #include <atomic>
-#include <functional>
 
+struct SnapshotBookHeader;
+struct SnapshotOrder;
+
+// Not thread-safe: a book is owned by exactly one shard thread, which is the
+// only caller of match/cancel/modify. Other threads may only read the last
+// traded price, the published market data and the instrument.
 class OrderBook {
 public:
+    explicit OrderBook(const Instrument& instrument = Instrument{}, const BookConfig& config = BookConfig{});
+
     void match(const Order& order);
-    void match(const Order& order, const std::function<void(double)>& onMatchPrice);
+
+    // Cancel or amend a resting order or pending STOP by id. Only the user
+    // who owns the order may touch it. Reducing quantity at the same price
+    // keeps time priority; any other change re-enters the order at the back.
+    // A modify to a quantity, or except for STOP_MARKET a price, of zero or
+    // less is rejected and leaves the order as it was.
+    bool cancel(int orderId, int userId);
+    bool modify(int orderId, int userId, Price newPrice, Quantity newQuantity);
     
-    double getLastTradedPrice() const;
-    void setLastTradedPrice(double price);
+    Price getLastTradedPrice() const;
+    void setLastTradedPrice(Price price);
+
+    // Top of book and session statistics as of the last completed
+    // match/cancel/modify. Safe from any thread and never blocks the owner.
+    MarketData getMarketData() const;
+
+    // Streams a DepthUpdate into `ring` for every level this book changes,
+    // tagged with `symbol`. The ring is never waited on: when it is full,
+    // records are dropped and a depth snapshot follows once there is room.
+    // Owning thread only, before the book is used.
+    void attachDepthFeed(SpscRing<DepthUpdate>* ring, SymbolId symbol);
+
+    // Reports what happens to CONSOLE_USER_ID's orders into `ring`, tagged
+    // with `symbol`. Like the depth feed the ring is never waited on; a
+    // report that doesn't fit is dropped. Owning thread only.
+    void attachExecutionSink(SpscRing<ExecutionReport>* ring, SymbolId symbol);
+
+    // Appends every fill of an order whose owner is `fromUserId` or above to
+    // `fills`. The shard publishes them after the result of the request that
+    // made them, so unlike reports none are dropped. Owning thread only.
+    void attachFillSink(std::vector<Fill>* fills, int fromUserId);
+
+    const Instrument& getInstrument() const;
+
+    // Appends this book's resting, STOP and ICEBERG state to `out` as one
+    // snapshot section and returns the number of orders written
+    size_t saveSnapshot(SymbolId symbol, std::vector<char>& out) const;
+
+    // Rebuilds state saved by saveSnapshot into an empty book
+    void loadSnapshot(const SnapshotBookHeader& header, const SnapshotOrder* orders);
 
 private:
-    std::map<double, std::deque<Order>> asks;
-    std::map<double, std::deque<Order>> bids;
+    Instrument instrument;
+
+    // Every resting and pending STOP order lives in this pool; the books below
+    // only link pool nodes into per-level FIFOs
+    OrderPool pool;
+
+    // Order id -> pool node for everything resting in asks/bids or pending in
+    // the STOP books, so cancel and modify never scan price levels
+    OrderIndex orderIndex;
+
+    BookSide asks;
+    BookSide bids;
     
     // STOP order books - separate from regular orders
-    std::map<double, std::deque<Order>> stopAsks;  // STOP SELL orders
-    std::map<double, std::deque<Order>> stopBids;  // STOP BUY orders
-    
-    // ICEBERG order books - track hidden quantities
-    std::map<double, std::deque<Order>> icebergAsks;  // ICEBERG SELL orders
-    std::map<double, std::deque<Order>> icebergBids;  // ICEBERG BUY orders
+    std::map<Price, OrderQueue> stopAsks;  // STOP SELL orders
+    std::map<Price, OrderQueue> stopBids;  // STOP BUY orders
+
+    std::atomic<Price> last_traded_price; 
 
-    std::mutex orderBookMutex;
-    std::atomic<double> last_traded_price {100.0}; 
+    // Owner's working copy of the session statistics and the lock readers
+    // copy it from; publishMarketData() refreshes the top of book and stores it
+    MarketData market;
+    double tradedNotional = 0.0;
+    SeqLock<MarketData> marketData;
+
+    // Incremental L2 feed, if attached
+    size_t depthSnapshotLevels;
+    size_t depthSnapshotInterval;
+    SpscRing<DepthUpdate>* depthRing = nullptr;
+    SymbolId depthSymbol = 0;
+    uint64_t depthSequence = 0;
+    uint64_t depthSinceSnapshot = 0;
+    bool depthResync = false;
+
+    // Execution reports and gateway fills, if attached
+    SpscRing<ExecutionReport>* executionRing = nullptr;
+    SymbolId executionSymbol = 0;
+    std::vector<Fill>* fillSink = nullptr;
+    int fillUserBase = 0;
+
+    // Triggered STOP orders waiting to be matched, oldest first, and whether
+    // a checkStopTriggers call further up the stack is already draining them
+    std::vector<Order> triggeredStops;
+    bool drainingStops = false;
     
+    void execute(const Order& order);
+    NodeIndex addToBook(const Order& order);
+    void unlinkOrder(NodeIndex index);
     void addToStopBook(const Order& order);
-    void addToIcebergBook(const Order& order);
-    void addToIcebergTrackingOnly(const Order& order);
-    void checkStopTriggers(double lastTradePrice, const std::function<void(double)>& onMatchPrice);
-    void processTriggeredOrder(const Order& order, const std::function<void(double)>& onMatchPrice);
-    void refillIcebergOrder(const Order& fullyExecutedOrder, double tradedQty, const std::function<void(double)>& onMatchPrice);
+    void checkStopTriggers(Price lastTradePrice);
+    void queueTriggeredLevel(OrderQueue& stopOrders, Price lastTradePrice);
+    bool releaseStop(Order& triggeredOrder, Price lastTradePrice);
+    bool refillIceberg(NodeIndex index, OrderQueue& level);
+    OrderQueue& levelOf(const Order& order);
+    void recordTrade(Side aggressor, Price price, Quantity quantity);
+    void publishMarketData();
+    void depthChanged(Side side, Price price, Quantity quantity);
+    void pushDepth(const DepthUpdate& update);
+    void publishDepthSnapshot();
+
+    bool wantsReport(int userId) const {
+        return executionRing != nullptr && userId == CONSOLE_USER_ID;
+    }
+    bool wantsFill(int userId) const {
+        return fillSink != nullptr && userId >= fillUserBase;
+    }
+    void pushReport(ExecutionReport& report);
+    void reportRejected(OrderAction action, int orderId, int userId, RejectReason reason);
 };
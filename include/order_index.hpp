@@ -0,0 +1,35 @@
+#pragma once
+
+#include "order_pool.hpp"
+#include <cstddef>
+#include <vector>
+
+// Open-addressing hash map from order id to pool node. Linear probing with
+// backward-shift deletion keeps it tombstone-free, and slots are plain
+// structs in one array, so lookups, inserts and erases never allocate once
+// the table has grown to the working-set size.
+class OrderIndex {
+public:
+    explicit OrderIndex(size_t initialCapacity = 1024);
+
+    void insert(int orderId, NodeIndex node);
+    NodeIndex find(int orderId) const;
+    void erase(int orderId);
+
+    size_t size() const { return count; }
+
+private:
+    static constexpr int EMPTY = -1;
+
+    struct Slot {
+        int orderId = EMPTY;
+        NodeIndex node = NULL_NODE;
+    };
+
+    size_t home(int orderId) const;
+    void grow();
+
+    std::vector<Slot> slots;
+    size_t mask;
+    size_t count = 0;
+};
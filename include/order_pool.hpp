@@ -0,0 +1,100 @@
+#pragma once
+
+#include "order.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using NodeIndex = std::uint32_t;
+constexpr NodeIndex NULL_NODE = UINT32_MAX;
+
+// A resting order together with its links in the level FIFO it belongs to
+struct OrderNode {
+    Order order;
+    NodeIndex prev = NULL_NODE;
+    NodeIndex next = NULL_NODE;
+};
+
+// Slab of fixed-size order nodes. Nodes are addressed by index, allocated in
+// chunks that never move, and recycled through a free list, so after warm-up
+// resting an order or filling it never touches the heap.
+class OrderPool {
+public:
+    explicit OrderPool(size_t chunkSize = 4096, size_t initialCapacity = 0);
+
+    NodeIndex allocate(const Order& order);
+    void release(NodeIndex index);
+
+    OrderNode& operator[](NodeIndex index) {
+        return chunks[index >> chunkShift][index & chunkMask];
+    }
+
+    const OrderNode& operator[](NodeIndex index) const {
+        return chunks[index >> chunkShift][index & chunkMask];
+    }
+
+    size_t capacity() const { return chunks.size() << chunkShift; }
+    size_t inUse() const { return used; }
+
+private:
+    void grow();
+
+    unsigned chunkShift;
+    NodeIndex chunkMask;
+    std::vector<std::unique_ptr<OrderNode[]>> chunks;
+    NodeIndex freeHead = NULL_NODE;
+    size_t used = 0;
+};
+
+// Intrusive FIFO of pool nodes, one per price level. Also keeps the total
+// quantity linked into it: nodes count with their quantity when linked, and
+// a resting order whose quantity changes in place must go through reduce().
+class OrderQueue {
+public:
+    bool empty() const { return head == NULL_NODE; }
+    NodeIndex front() const { return head; }
+    Quantity totalQuantity() const { return quantity; }
+
+    void reduce(Quantity amount) { quantity -= amount; }
+
+    void pushBack(OrderPool& pool, NodeIndex index) {
+        OrderNode& node = pool[index];
+        node.prev = tail;
+        node.next = NULL_NODE;
+        if (tail != NULL_NODE) {
+            pool[tail].next = index;
+        } else {
+            head = index;
+        }
+        tail = index;
+        quantity += node.order.quantity;
+    }
+
+    NodeIndex popFront(OrderPool& pool) {
+        NodeIndex index = head;
+        remove(pool, index);
+        return index;
+    }
+
+    void remove(OrderPool& pool, NodeIndex index) {
+        OrderNode& node = pool[index];
+        if (node.prev != NULL_NODE) {
+            pool[node.prev].next = node.next;
+        } else {
+            head = node.next;
+        }
+        if (node.next != NULL_NODE) {
+            pool[node.next].prev = node.prev;
+        } else {
+            tail = node.prev;
+        }
+        node.prev = NULL_NODE;
+        node.next = NULL_NODE;
+        quantity -= node.order.quantity;
+    }
+
+private:
+    NodeIndex head = NULL_NODE;
+    NodeIndex tail = NULL_NODE;
+    Quantity quantity = 0;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "order.hpp"
+#include "order_book.hpp"
+#include "spsc_ring.hpp"
+#include "spin_wait.hpp"
+#include "snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <thread>
+
+struct ShardConfig {
+    int cpu = -1;                         // -1 = not pinned
+    size_t inboxCapacity = 1 << 16;       // Sequenced orders waiting to be matched
+    size_t resultCapacity = 1 << 16;      // Results waiting for the publish stage
+    size_t depthCapacity = 1 << 16;       // Depth feed records waiting for the publish stage
+    size_t executionCapacity = 1 << 12;   // Execution reports waiting for the console
+    bool gatewayFills = false;            // Publish fills of gateway users' orders with the results
+    size_t batchSize = 256;               // Orders drained per inbox poll
+    WaitStrategy waitStrategy = WaitStrategy::SPIN_THEN_PARK;
+    unsigned spinIterations = 10000;      // Empty polls before the shard parks
+};
+
+// REQUEST: the outcome of one sequenced request. FILL: one fill of a gateway
+// user's order made by that request, published right after its REQUEST on
+// the same ring, so the owner sees the ack first and no fill is ever dropped.
+enum class OrderResultKind : uint8_t {
+    REQUEST,
+    FILL
+};
+
+// Handed from a shard to the publish stage
+struct OrderResult {
+    uint64_t sequence;
+    int orderId;
+    int userId;
+    SymbolId symbol;
+    OrderAction action;
+    bool accepted;        // False if a cancel or modify was rejected
+    Ticks submitted;
+    OrderStages stages{};
+    uint64_t clientTag = 0;
+    OrderResultKind kind = OrderResultKind::REQUEST;
+
+    // FILL only; orderId, userId and clientTag are the filled order's
+    Price price = 0;
+    Quantity quantity = 0;
+    Side side = Side::BUY;  // The filled order's side
+    bool maker = false;     // The filled order was resting
+};
+
+// A matching thread that exclusively owns the order books of the symbols
+// routed to it. Books are only ever touched from this thread, so matching
+// needs no locks. The sequencer is the only producer of the inbox and the
+// publish stage the only consumer of the results, so both are SPSC rings
+// and orders are matched in exactly the sequence they were stamped with.
+class Shard {
+public:
+    // `snapshotWriter` receives this shard's books for each SNAPSHOT request,
+    // or is null if snapshots are disabled
+    Shard(size_t index, const ShardConfig& config, Parker& resultParker, SnapshotWriter* snapshotWriter);
+    ~Shard();
+
+    Shard(const Shard&) = delete;
+    Shard& operator=(const Shard&) = delete;
+
+    void addBook(SymbolId symbol, const Instrument& instrument, const BookConfig& bookConfig);
+    OrderBook* getBook(SymbolId symbol);
+
+    void start();
+    void stop();
+
+    // Applies a journaled request directly; only valid before start()
+    void replay(const Order& order);
+
+    // Sequencer thread only. Spins while the inbox is full; call notify()
+    // once the batch is complete.
+    void submit(const Order& order);
+    void notify();
+
+    // Publish stage only
+    size_t pollResults(OrderResult* out, size_t maxResults);
+    bool hasResults() const;
+    size_t pollDepth(DepthUpdate* out, size_t maxUpdates);
+    bool hasDepthUpdates() const;
+
+    // Single consumer: whoever renders execution reports
+    size_t pollExecutions(ExecutionReport* out, size_t maxReports);
+
+    size_t getInboxDepth() const;
+
+private:
+    void run();
+    bool process(const Order& order);
+    static bool isValidNewOrder(const Order& order);
+    static bool isValidModify(const Order& order);
+    void takeSnapshot(const Order& request);
+    void publish(const OrderResult& result);
+
+    size_t index;
+    ShardConfig config;
+
+    std::vector<std::unique_ptr<OrderBook>> books;  // Indexed by SymbolId, null if not owned
+
+    SpscRing<Order> inbox;
+    Parker inboxParker;
+    SpscRing<OrderResult> results;
+    SpscRing<DepthUpdate> depthUpdates;   // Shared by every book of this shard
+    SpscRing<ExecutionReport> executions; // Shared by every book of this shard
+    std::vector<Fill> fills;              // Gateway fills of the request being matched
+    Parker& resultParker;
+    SnapshotWriter* snapshotWriter;
+    std::atomic<bool> running{false};
+
+    std::thread worker;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "depth_feed.hpp"
+#include "instrument.hpp"
+#include "mpsc_ring.hpp"
+#include "tsc_clock.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ShmFeedConfig {
+    std::string name;                     // POSIX shared memory name, e.g. /orderbook_md; empty = no feed
+    size_t capacity = 1 << 16;            // Messages kept in the ring, rounded up to a power of two
+};
+
+// One market data message as subscribers see it: a trade or a book update
+// from one book's depth feed, stamped with the feed sequence and the moment
+// it was written to shared memory
+struct ShmFeedMessage {
+    uint64_t sequence;       // Position in the feed, from 1, across all symbols
+    uint64_t bookSequence;   // The book's own depth feed sequence
+    Ticks published;         // TscClock ticks when the publisher wrote it
+    Price price;
+    Quantity quantity;
+    SymbolId symbol;
+    DepthUpdateKind kind;
+    Side side;
+    uint8_t reserved[4];
+};
+
+static_assert(sizeof(ShmFeedMessage) % sizeof(uint64_t) == 0, "messages are copied word by word");
+
+constexpr size_t SHM_FEED_MAX_SYMBOLS = 64;
+
+struct ShmFeedSymbol {
+    char name[16];
+    double tickSize;
+    double lotSize;
+};
+
+// Start of the segment. Everything above writeSequence is written once when
+// the publisher creates the segment.
+struct ShmFeedHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t messageSize;
+    uint64_t capacity;
+    uint32_t symbolCount;
+    uint32_t usesTsc;        // Whether `published` stamps are TSC ticks
+    ShmFeedSymbol symbols[SHM_FEED_MAX_SYMBOLS];
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> writeSequence;   // Last message published
+    std::atomic<uint32_t> closed;                                   // Set when the publisher shuts down
+};
+
+// A message slot. `sequence` is the message it holds, or 0 while the
+// publisher is overwriting it; the payload is stored as relaxed atomic words
+// so a reader racing the publisher gets a discarded copy, not a data race.
+struct alignas(CACHE_LINE_SIZE) ShmFeedSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[sizeof(ShmFeedMessage) / sizeof(uint64_t)];
+};
+
+// Single-writer broadcast ring in POSIX shared memory. The publisher never
+// waits for subscribers and does not know about them: it overwrites the
+// oldest slot, and any number of processes map the segment read-only and
+// read messages straight out of it, with no system call per message. A
+// subscriber that falls a whole ring behind finds its next slot overwritten
+// and knows it was lapped.
+class ShmPublisher {
+public:
+    ShmPublisher(const ShmFeedConfig& config, const std::vector<Instrument>& instruments);
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    // Creates the segment, replacing a stale one left by an earlier run. On
+    // failure returns false and describes why in `error`.
+    bool open(std::string& error);
+
+    // Publisher thread only
+    void publish(const DepthUpdate& update);
+
+    // Tells subscribers the feed has ended and removes the name; processes
+    // that still have the segment mapped keep it until they unmap it
+    void close();
+
+private:
+    ShmFeedConfig config;
+    std::vector<Instrument> instruments;
+
+    size_t mappedSize = 0;
+    ShmFeedHeader* header = nullptr;
+    ShmFeedSlot* slots = nullptr;
+    uint64_t mask = 0;
+    uint64_t sequence = 0;
+};
+
+class ShmSubscriber {
+public:
+    enum class ReadStatus {
+        MESSAGE,     // `out` holds the next message
+        EMPTY,       // Nothing new yet
+        LAPPED,      // The next message was overwritten; reading resumes at the newest
+        CLOSED       // The publisher shut down and everything it wrote was read
+    };
+
+    ShmSubscriber() = default;
+    ~ShmSubscriber();
+
+    ShmSubscriber(const ShmSubscriber&) = delete;
+    ShmSubscriber& operator=(const ShmSubscriber&) = delete;
+
+    // Maps an existing feed; reading starts after the newest message
+    bool open(const std::string& name, std::string& error);
+
+    ReadStatus poll(ShmFeedMessage& out);
+
+    const ShmFeedHeader& getHeader() const { return *header; }
+    uint64_t getLostMessages() const { return lost; }
+
+private:
+    size_t mappedSize = 0;
+    const ShmFeedHeader* header = nullptr;
+    const ShmFeedSlot* slots = nullptr;
+    uint64_t mask = 0;
+    uint64_t next = 1;
+    uint64_t lost = 0;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "order.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SnapshotConfig {
+    std::string path;                // Empty = no snapshots
+    uint64_t everyRequests = 0;      // Take one every N sequenced requests, 0 = on request only
+};
+
+// Snapshot file layout, all fixed-size little-endian records:
+//   SnapshotFileHeader
+//   per book: SnapshotBookHeader, then resting, stop and iceberg tracking
+//             orders as SnapshotOrder records, each group in queue order.
+//             Resting ICEBERG slices carry the remaining size in
+//             totalQuantity; tracking orders are only read from older files.
+struct SnapshotFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t bookCount;
+    uint64_t sequence;       // Every request up to and including this one is in the snapshot
+    uint64_t layoutHash;
+    int64_t nextOrderId;
+    uint8_t reserved[24];
+};
+
+struct SnapshotBookHeader {
+    SymbolId symbol;
+    uint16_t reserved;
+    uint32_t restingCount;
+    uint32_t stopCount;
+    uint32_t icebergCount;
+    Price lastTradedPrice;
+};
+
+struct SnapshotOrder {
+    int32_t id;
+    int32_t userId;
+    Price price;
+    Quantity quantity;
+    Price triggerPrice;
+    Quantity totalQuantity;
+    Quantity displayQuantity;
+    uint8_t type;
+    uint8_t side;
+    SymbolId symbol;
+    uint8_t reserved[4];
+};
+
+static_assert(sizeof(SnapshotFileHeader) == 64, "snapshot header must stay 64 bytes");
+static_assert(sizeof(SnapshotBookHeader) == 24, "snapshot book header must stay 24 bytes");
+static_assert(sizeof(SnapshotOrder) == 56, "snapshot orders must stay 56 bytes");
+
+SnapshotOrder toSnapshotOrder(const Order& order);
+Order fromSnapshotOrder(const SnapshotOrder& record);
+
+// Reads a whole snapshot file with one read and checks its header
+bool readSnapshotFile(const std::string& path, uint64_t layoutHash, std::vector<char>& data, std::string& error);
+
+// Collects the serialized books every shard produces for one snapshot
+// sequence point and writes them out on a background thread, so the shards
+// only pay for copying their own books into memory.
+class SnapshotWriter {
+public:
+    SnapshotWriter(const std::string& path, uint64_t layoutHash, size_t shardCount);
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void start();
+    void stop();
+
+    // Called by each shard thread once per snapshot with its serialized books
+    void contribute(uint64_t sequence, int64_t nextOrderId, uint32_t bookCount, std::vector<char>&& books);
+
+    uint64_t getLastWrittenSequence() const;
+
+private:
+    struct Pending {
+        int64_t nextOrderId = 0;
+        uint32_t bookCount = 0;
+        size_t contributions = 0;
+        std::vector<char> books;
+    };
+
+    void run();
+    bool write(uint64_t sequence, const Pending& snapshot);
+
+    std::string path;
+    uint64_t layoutHash;
+    size_t shardCount;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::map<uint64_t, Pending> pending;              // Waiting for more shards
+    std::deque<std::pair<uint64_t, Pending>> ready;   // Complete, waiting to be written
+    uint64_t lastWrittenSequence = 0;
+    bool running = false;
+
+    std::thread writerThread;
+};
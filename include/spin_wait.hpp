@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+enum class WaitStrategy {
+    BUSY_SPIN,       // Never sleep: lowest latency, burns a core while idle
+    SPIN_THEN_PARK   // Spin for a while, then sleep until a producer wakes us
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Idle handling for the single consumer of a ring. Producers only pay for a
+// mutex and notify when the consumer has actually gone to sleep.
+class Parker {
+public:
+    explicit Parker(unsigned spinLimit = 10000) : spinLimit(spinLimit) {}
+
+    // Producer side, called after publishing an item
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_one();
+        }
+    }
+
+    // Wakes the consumer unconditionally, e.g. on shutdown
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_all();
+    }
+
+    // Consumer side, called when a poll found nothing. `idleSpins` counts
+    // consecutive empty polls and is reset once the consumer has slept.
+    template <typename Ready>
+    void wait(WaitStrategy strategy, unsigned& idleSpins, Ready ready) {
+        if (strategy == WaitStrategy::BUSY_SPIN || ++idleSpins < spinLimit) {
+            cpuRelax();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // The timeout only bounds the damage of a missed wakeup; it is not
+        // part of normal operation
+        cv.wait_for(lock, std::chrono::milliseconds(1), ready);
+        sleeping.store(false, std::memory_order_relaxed);
+        idleSpins = 0;
+    }
+
+private:
+    unsigned spinLimit;
+    std::atomic<bool> sleeping{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "mpsc_ring.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded single-producer / single-consumer ring connecting two pipeline
+// stages. Each side owns one position counter and keeps a cached copy of the
+// other side's, so the shared counter is only re-read when the cached value
+// says the ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots.reset(new T[size]);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only. Returns false if the ring is full.
+    bool tryPush(const T& item) {
+        size_t tail = writePos.load(std::memory_order_relaxed);
+        if (tail - cachedReadPos > mask) {
+            cachedReadPos = readPos.load(std::memory_order_acquire);
+            if (tail - cachedReadPos > mask) {
+                return false;
+            }
+        }
+        slots[tail & mask] = item;
+        writePos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer only. How many pushes in a row are certain to succeed.
+    size_t freeSlots() {
+        cachedReadPos = readPos.load(std::memory_order_acquire);
+        return mask + 1 - (writePos.load(std::memory_order_relaxed) - cachedReadPos);
+    }
+
+    // Consumer only. Moves up to `maxItems` items into `out`.
+    size_t tryPopBatch(T* out, size_t maxItems) {
+        size_t head = readPos.load(std::memory_order_relaxed);
+        if (cachedWritePos == head) {
+            cachedWritePos = writePos.load(std::memory_order_acquire);
+        }
+
+        size_t available = cachedWritePos - head;
+        size_t count = available < maxItems ? available : maxItems;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = slots[(head + i) & mask];
+        }
+        if (count > 0) {
+            readPos.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Consumer only
+    bool empty() const {
+        return readPos.load(std::memory_order_relaxed) == writePos.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Approximate number of queued items, safe to call from any thread
+    size_t sizeApprox() const {
+        size_t head = readPos.load(std::memory_order_relaxed);
+        size_t tail = writePos.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    std::unique_ptr<T[]> slots;
+    size_t mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> writePos{0};
+    size_t cachedReadPos = 0;       // Producer's view of readPos
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> readPos{0};
+    size_t cachedWritePos = 0;      // Consumer's view of writePos
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ORDERBOOK_HAS_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define ORDERBOOK_HAS_RDTSC 1
+#endif
+
+// Raw clock ticks; TSC cycles or steady_clock nanoseconds depending on the CPU
+using Ticks = uint64_t;
+
+// Cheap monotonic clock for hot-path timing and order stamps. Reads the TSC
+// directly when the CPU reports an invariant one (constant rate, not stopped
+// in sleep states) and falls back to steady_clock otherwise. Ticks are only
+// converted to nanoseconds when something is reported.
+class TscClock {
+public:
+    static Ticks now() {
+#ifdef ORDERBOOK_HAS_RDTSC
+        if (tscEnabled)
+            return __rdtsc();
+#endif
+        return steadyNow();
+    }
+
+    // Like now(), but waits for earlier instructions to finish first, so the
+    // end of a timed region isn't read before the work inside it completes
+    static Ticks nowOrdered() {
+#ifdef ORDERBOOK_HAS_RDTSC
+        if (tscEnabled) {
+            unsigned int aux;
+            return __rdtscp(&aux);
+        }
+#endif
+        return steadyNow();
+    }
+
+    // Ticks from `start` to `end`; zero if the reads came from cores whose
+    // counters disagree by more than the interval
+    static Ticks elapsed(Ticks start, Ticks end) {
+        return end > start ? end - start : 0;
+    }
+
+    static double toNanos(Ticks ticks) { return static_cast<double>(ticks) * nanosPerTick(); }
+    static bool usesTsc() { return tscEnabled; }
+
+    // Measured against steady_clock once, the first time a tick is converted
+    static double nanosPerTick();
+
+private:
+    static Ticks steadyNow() {
+        return static_cast<Ticks>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static const bool tscEnabled;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine.hpp"
+#include "console_reporter.hpp"
 #include <atomic>
 #include <thread>
 
@@ -15,7 +16,8 @@ public:
 private:
     Engine& engine;
     std::atomic<bool> running;
-    int orderId;
+    SymbolId symbol;  // Symbol that orders and price queries apply to
+    ConsoleReporter reporter;  // Prints what happens to the orders entered here
 
     void interactiveInput();
 };
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// xoshiro256** run as LANES independent generators side by side. The state
+// is stored lane-major (one array per state word), so filling a buffer is a
+// loop of plain shifts, xors and adds across the lanes that the compiler can
+// turn into SIMD code. Meant for bulk draws; one value at a time is cheaper
+// with a single generator.
+class Xoshiro256x4 {
+public:
+    static constexpr size_t LANES = 4;
+
+    explicit Xoshiro256x4(uint64_t seed) {
+        // Lanes are seeded from one splitmix64 stream, as the xoshiro authors
+        // recommend, so they start far apart
+        uint64_t x = seed;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            s0[lane] = splitmix64(x);
+            s1[lane] = splitmix64(x);
+            s2[lane] = splitmix64(x);
+            s3[lane] = splitmix64(x);
+        }
+    }
+
+    // Fills `out` with `count` random 64-bit values; a count that is not a
+    // multiple of LANES discards the unused tail of the last step
+    void fill(uint64_t* out, size_t count) {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES) {
+            step(out + i);
+        }
+        if (i < count) {
+            uint64_t tail[LANES];
+            step(tail);
+            for (size_t lane = 0; lane < count - i; ++lane) {
+                out[i + lane] = tail[lane];
+            }
+        }
+    }
+
+    // Uniform in [0, 1) from the top 53 bits
+    static double toUnit(uint64_t bits) {
+        return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [0, range) by multiply-shift; the bias is below 2^-32 for
+    // any range this simulator uses
+    static uint64_t toRange(uint64_t bits, uint64_t range) {
+        return ((bits >> 32) * range) >> 32;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    void step(uint64_t* out) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            uint64_t s1x5 = s1[lane] + (s1[lane] << 2);     // * 5
+            uint64_t r = rotl(s1x5, 7);
+            out[lane] = r + (r << 3);                       // * 9
+
+            uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotl(s3[lane], 45);
+        }
+    }
+
+    alignas(32) uint64_t s0[LANES];
+    alignas(32) uint64_t s1[LANES];
+    alignas(32) uint64_t s2[LANES];
+    alignas(32) uint64_t s3[LANES];
+};
@@ -2,17 +2,45 @@
 #include "benchmark.hpp"
 #include "order.hpp"
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
 
-BackgroundGenerator::BackgroundGenerator(OrderBook& orderBook_) 
-    : orderBook(orderBook_),
-      running(false),
-      rng(std::random_device{}()),
-      priceDist(70.0, 120.0), 
-      qtyDist(1.0, 10.0),
-      userIdDist(1001, 9999),
-      sideDist(0, 1),
-      typeDist(0, 19),
-      orderId(10000) {
+namespace {
+constexpr size_t OPEN_ORDER_HISTORY = 4096;
+constexpr double TWO_PI = 6.283185307179586;
+
+// Same bands the generator has always drawn from
+constexpr double MIN_PRICE = 70.0;
+constexpr double MAX_PRICE = 120.0;
+constexpr double MIN_QUANTITY = 1.0;
+constexpr double MAX_QUANTITY = 10.0;
+constexpr int MIN_USER_ID = 1001;
+constexpr int MAX_USER_ID = 9999;
+
+double unit(uint64_t bits) {
+    return Xoshiro256x4::toUnit(bits);
+}
+
+double between(uint64_t bits, double low, double high) {
+    return low + (high - low) * unit(bits);
+}
+}
+
+BackgroundGenerator::BackgroundGenerator(Engine& engine_, const GeneratorConfig& config_)
+    : engine(engine_),
+      config(config_),
+      running(false) {
+    if (config.producers == 0) {
+        config.producers = 1;
+    }
+}
+
+BackgroundGenerator::Producer::Producer(uint64_t seed, size_t symbolCount)
+    : rng(seed),
+      mids(symbolCount, 0.0) {
+    openOrders.reserve(OPEN_ORDER_HISTORY);
 }
 
 BackgroundGenerator::~BackgroundGenerator() {
@@ -22,40 +50,178 @@ BackgroundGenerator::~BackgroundGenerator() {
 void BackgroundGenerator::start() {
     if (!running.load()) {
         running.store(true);
-        bgThread = std::thread(&BackgroundGenerator::tradeLoop, this);
+        std::random_device seeds;
+        for (size_t i = 0; i < config.producers; ++i) {
+            uint64_t seed = config.flow.seed != 0 ? config.flow.seed + i : (uint64_t(seeds()) << 32) | seeds();
+            producers.push_back(std::make_unique<Producer>(seed, engine.getSymbolCount()));
+        }
+        for (auto& producer : producers) {
+            producer->thread = std::thread(&BackgroundGenerator::tradeLoop, this, std::ref(*producer));
+        }
     }
 }
 
 void BackgroundGenerator::stop() {
     if (running.load()) {
         running.store(false);
-        if (bgThread.joinable()) {
-            bgThread.join();
+        for (auto& producer : producers) {
+            if (producer->thread.joinable()) {
+                producer->thread.join();
+            }
+        }
+        producers.clear();
+    }
+}
+
+const GeneratorConfig& BackgroundGenerator::getConfig() const {
+    return config;
+}
+
+// Generates a batch, then hands it to the engine. Unpaced, the whole batch
+// goes in one ring operation. Paced, each producer follows a fixed schedule
+// for its share of the rate (exponential gaps with Poisson arrivals), and
+// every order that is due by the time the producer wakes goes in together,
+// so a late wakeup is made up instead of lowering the rate.
+void BackgroundGenerator::tradeLoop(Producer& producer) {
+    using Clock = std::chrono::steady_clock;
+
+    bool paced = config.ratePerSecond > 0.0;
+    auto next = Clock::now();
+
+    while (running.load(std::memory_order_relaxed)) {
+        generateBatch(producer);
+
+        size_t sent = 0;
+        while (sent < BATCH_SIZE && running.load(std::memory_order_relaxed)) {
+            size_t end = BATCH_SIZE;
+            if (paced) {
+                next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(producer.gaps[sent]));
+                if (Clock::now() < next) {
+                    std::this_thread::sleep_until(next);
+                }
+                auto now = Clock::now();
+                end = sent + 1;
+                while (end < BATCH_SIZE) {
+                    auto due = next + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(producer.gaps[end]));
+                    if (due > now) {
+                        break;
+                    }
+                    next = due;
+                    ++end;
+                }
+            }
+
+            // Stamped when handed over, not when generated, so latency
+            // measured from the timestamp never includes time spent waiting
+            // in this batch
+            Ticks submitted = TscClock::now();
+            for (size_t i = sent; i < end; ++i) {
+                producer.orders[i].timestamp = submitted;
+            }
+            engine.submitOrders(producer.orders + sent, end - sent);
+            sent = end;
         }
     }
 }
 
-void BackgroundGenerator::tradeLoop() {
-    while (running.load()) {
-        {
-            BENCHMARK_TIMER("Background_Order_Generation");
-            
-            Order order = generateRandomOrder();
-            orderBook.match(order);
-            Benchmark::getInstance().incrementCounter("Background_Orders_Generated");
+void BackgroundGenerator::generateBatch(Producer& producer) {
+    BENCHMARK_TIMER(Timing::BACKGROUND_ORDER_GENERATION);
+
+    producer.rng.fill(&producer.draws[0][0], DRAW_COUNT * BATCH_SIZE);
+
+    // Read once per batch: the models only need the market roughly where it is
+    std::vector<Price> lastTrades(engine.getSymbolCount());
+    for (size_t symbol = 0; symbol < lastTrades.size(); ++symbol) {
+        lastTrades[symbol] = engine.getOrderBook(static_cast<SymbolId>(symbol)).getLastTradedPrice();
+    }
+
+    int firstId = engine.reserveOrderIds(static_cast<int>(BATCH_SIZE));
+    size_t orders = 0;
+    for (size_t i = 0; i < BATCH_SIZE; ++i) {
+        Order& order = producer.orders[i];
+        if (buildCancel(producer, i, order)) {
+            continue;
+        }
+        order = Order{};
+        order.id = firstId + static_cast<int>(i);
+        buildOrder(producer, i, order, lastTrades);
+        rememberOrder(producer, order);
+        ++orders;
+    }
+
+    if (config.ratePerSecond > 0.0) {
+        double meanGap = config.producers / config.ratePerSecond;
+        for (size_t i = 0; i < BATCH_SIZE; ++i) {
+            producer.gaps[i] = config.flow.poissonArrivals
+                ? -std::log(1.0 - unit(producer.draws[DRAW_GAP][i])) * meanGap
+                : meanGap;
         }
+    }
+
+    BENCHMARK_ADD(Counter::BACKGROUND_ORDERS_GENERATED, static_cast<long>(orders));
+}
+
+// Turns slot `i` into a cancel of one of the producer's remembered orders,
+// `cancelRatio` of the time. The order may already have traded, in which case
+// the engine rejects it like any late cancel.
+bool BackgroundGenerator::buildCancel(Producer& producer, size_t i, Order& request) {
+    if (config.flow.cancelRatio <= 0.0 || producer.openOrders.empty() ||
+        unit(producer.draws[DRAW_CANCEL][i]) >= config.flow.cancelRatio) {
+        return false;
+    }
+
+    size_t index = Xoshiro256x4::toRange(producer.draws[DRAW_PICK][i], producer.openOrders.size());
+    const OpenOrder& cancel = producer.openOrders[index];
+    request = Order{};
+    request.id = cancel.id;
+    request.userId = cancel.userId;
+    request.symbol = cancel.symbol;
+    request.action = OrderAction::CANCEL;
+
+    producer.openOrders[index] = producer.openOrders.back();
+    producer.openOrders.pop_back();
+    return true;
+}
+
+void BackgroundGenerator::rememberOrder(Producer& producer, const Order& order) {
+    if (config.flow.cancelRatio <= 0.0 || order.type == OrderType::MARKET) {
+        return;
+    }
 
-        // 2ms sleep = ~500 orders/sec
-        //std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    OpenOrder open{order.id, order.userId, order.symbol};
+    if (producer.openOrders.size() < OPEN_ORDER_HISTORY) {
+        producer.openOrders.push_back(open);
+    } else {
+        producer.openOrders[producer.nextOpenOrder] = open;
+        producer.nextOpenOrder = (producer.nextOpenOrder + 1) % OPEN_ORDER_HISTORY;
     }
 }
 
-Order BackgroundGenerator::generateRandomOrder() {
-    Order order;
-    order.id = orderId++;
-    order.userId = userIdDist(rng);
-    
-    int typeRoll = typeDist(rng);
+// Most quotes join at or just behind the touch and the rest thin out with a
+// power-law tail, like the depth profile of a real book. A few are priced
+// through the mid and trade on arrival.
+Price BackgroundGenerator::quotePrice(const Producer& producer, size_t i, Side side, double mid) const {
+    const FlowConfig& flow = config.flow;
+    double u = 1.0 - unit(producer.draws[DRAW_PRICE][i]);   // (0, 1]
+    double depth = std::floor(std::pow(u, -1.0 / flow.depthExponent)) - 1.0;
+    Price ticks = static_cast<Price>(std::min(depth, static_cast<double>(flow.maxDepthTicks)));
+
+    Price touch = static_cast<Price>(std::llround(mid));
+    bool marketable = unit(producer.draws[DRAW_MARKETABLE][i]) < flow.marketableRatio;
+    if (side == Side::BUY) {
+        return marketable ? touch + ticks : touch - 1 - ticks;
+    }
+    return marketable ? touch - ticks : touch + 1 + ticks;
+}
+
+void BackgroundGenerator::buildOrder(Producer& producer, size_t i, Order& order, const std::vector<Price>& lastTrades) {
+    auto draw = [&](Draw column) { return producer.draws[column][i]; };
+
+    order.userId = MIN_USER_ID + static_cast<int>(Xoshiro256x4::toRange(draw(DRAW_USER), MAX_USER_ID - MIN_USER_ID + 1));
+    order.symbol = static_cast<SymbolId>(Xoshiro256x4::toRange(draw(DRAW_SYMBOL), lastTrades.size()));
+
+    int typeRoll = static_cast<int>(Xoshiro256x4::toRange(draw(DRAW_TYPE), 20));
     if (typeRoll <= 9) {
         order.type = OrderType::LIMIT;
     } else if (typeRoll <= 12) {
@@ -67,41 +233,67 @@ Order BackgroundGenerator::generateRandomOrder() {
     } else {
         order.type = OrderType::ICEBERG;
     }
-    
-    order.side = static_cast<Side>(sideDist(rng));
-    order.quantity = qtyDist(rng);
-    
+
+    order.side = static_cast<Side>(draw(DRAW_SIDE) >> 63);
+
+    const Instrument& instrument = engine.getInstrument(order.symbol);
+    double quantity = between(draw(DRAW_QUANTITY), MIN_QUANTITY, MAX_QUANTITY);
+    order.quantity = std::max<Quantity>(1, instrument.toLots(quantity));
+
+    // MARKET model: one step of the mid's random walk, pulled back toward the
+    // last trade so it follows the book instead of drifting away from it. The
+    // step is a standard normal from a Box-Muller pair.
+    bool marketModel = config.flow.model == FlowModel::MARKET;
+    Price lastTrade = lastTrades[order.symbol];
+    double mid = 0.0;
+    if (marketModel) {
+        const FlowConfig& flow = config.flow;
+        double& walk = producer.mids[order.symbol];
+        if (walk <= 0.0) {
+            walk = static_cast<double>(lastTrade);
+        }
+        double radius = std::sqrt(-2.0 * std::log(1.0 - unit(draw(DRAW_STEP_RADIUS))));
+        double step = radius * std::cos(TWO_PI * unit(draw(DRAW_STEP_ANGLE)));
+        walk += flow.midReversion * (static_cast<double>(lastTrade) - walk) + flow.midVolatilityTicks * step;
+        walk = std::max(walk, static_cast<double>(flow.maxDepthTicks) + 2.0);
+        mid = walk;
+    }
+    auto limitPrice = [&]() {
+        return marketModel ? quotePrice(producer, i, order.side, mid)
+                           : instrument.toTicks(between(draw(DRAW_PRICE), MIN_PRICE, MAX_PRICE));
+    };
+
     if (order.type == OrderType::STOP_LIMIT || order.type == OrderType::STOP_MARKET) {
-        double currentMarketPrice = orderBook.getLastTradedPrice();
+        double currentMarketPrice = marketModel ? instrument.toPrice(static_cast<Price>(std::llround(mid)))
+                                                : instrument.toPrice(lastTrade);
         if (currentMarketPrice <= 0) {
-            currentMarketPrice = 95.0;  
+            currentMarketPrice = 95.0;
         }
-        
+
+        double triggerPrice;
         if (order.side == Side::SELL) {
-            order.triggerPrice = currentMarketPrice * (0.85 + 0.10 * std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+            triggerPrice = currentMarketPrice * (0.85 + 0.10 * unit(draw(DRAW_TRIGGER)));
             if (order.type == OrderType::STOP_LIMIT) {
-                order.price = order.triggerPrice * (0.95 + 0.09 * std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+                order.price = instrument.toTicks(triggerPrice * (0.95 + 0.09 * unit(draw(DRAW_OFFSET))));
             } else {
-                order.price = 0.0;  
+                order.price = 0;
             }
         } else {
-            order.triggerPrice = currentMarketPrice * (1.05 + 0.10 * std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+            triggerPrice = currentMarketPrice * (1.05 + 0.10 * unit(draw(DRAW_TRIGGER)));
             if (order.type == OrderType::STOP_LIMIT) {
-                order.price = order.triggerPrice * (1.01 + 0.04 * std::uniform_real_distribution<double>(0.0, 1.0)(rng));
+                order.price = instrument.toTicks(triggerPrice * (1.01 + 0.04 * unit(draw(DRAW_OFFSET))));
             } else {
-                order.price = 0.0;  
+                order.price = 0;
             }
         }
+        order.triggerPrice = instrument.toTicks(triggerPrice);
     } else if (order.type == OrderType::ICEBERG) {
-        order.price = priceDist(rng);
-        order.totalQuantity = order.quantity * (3.0 + 5.0 * std::uniform_real_distribution<double>(0.0, 1.0)(rng));  
-        order.displayQuantity = order.quantity; 
-        order.quantity = order.totalQuantity;  
+        order.price = limitPrice();
+        // Coarse lots can round the total below the displayed slice
+        order.totalQuantity = std::max(order.quantity, instrument.toLots(quantity * (3.0 + 5.0 * unit(draw(DRAW_OFFSET)))));
+        order.displayQuantity = order.quantity;
+        order.quantity = order.totalQuantity;
     } else {
-        order.price = priceDist(rng);
+        order.price = limitPrice();
     }
-    
-    order.timestamp = std::chrono::high_resolution_clock::now();
-    
-    return order;
 }
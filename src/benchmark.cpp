@@ -8,6 +8,71 @@
 #include <vector>
 #include <cctype>
 
+namespace {
+
+const char* const COUNTER_NAMES[] = {
+    "Orders_Submitted",
+    "User_Orders_Submitted",
+    "Background_Orders_Generated",
+    "Orders_Dispatched",
+    "Orders_Processed",
+    "Orders_Matched",
+    "Volume_Traded",
+    "Orders_Resting",
+    "Orders_Cancelled",
+    "Orders_Modified",
+    "Cancels_Rejected",
+    "Modifies_Rejected",
+    "Orders_Rejected_Unknown_Symbol",
+    "Orders_Rejected_Invalid",
+    "Stop_Orders_Placed",
+    "Stop_Orders_Triggered",
+    "Stop_Orders_Rejected",
+    "Iceberg_Orders_Placed",
+    "Iceberg_Orders_Refilled",
+    "Results_Published",
+    "Requests_Rejected",
+    "Sequence_Order_Violations",
+    "Snapshots_Written",
+    "Depth_Updates",
+    "Depth_Updates_Dropped",
+    "Depth_Gaps",
+    "Gateway_Requests",
+    "Gateway_Sessions_Revoked",
+    "Gateway_Responses_Dropped",
+    "Execution_Reports",
+    "Execution_Reports_Dropped",
+};
+
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == COUNTER_COUNT,
+              "every Counter needs a display name");
+
+const char* const TIMING_NAMES[] = {
+    "Order_Submission",
+    "Submit_To_Dispatch",
+    "Dispatch_To_Pickup",
+    "Order_Processing",
+    "Match_To_Publish",
+    "Submit_To_Publish",
+    "OrderBook_Match",
+    "Stop_Trigger_Check",
+    "Background_Order_Generation",
+    "Snapshot_Pause",
+    "Snapshot_Write",
+};
+
+static_assert(sizeof(TIMING_NAMES) / sizeof(TIMING_NAMES[0]) == TIMING_COUNT,
+              "every Timing needs a display name");
+
+const double REPORTED_QUANTILES[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+const char* const QUANTILE_LABELS[] = {"p50", "p90", "p99", "p99.9", "p99.99"};
+
+double toMicros(double ticks) {
+    return ticks * TscClock::nanosPerTick() / 1000.0;
+}
+
+}
+
 Benchmark &Benchmark::getInstance() {
     static Benchmark instance;
     return instance;
@@ -22,7 +87,7 @@ Benchmark::Benchmark() : programStart(std::chrono::high_resolution_clock::now())
             std::cerr << "Warning: Could not open benchmarks.log file\n";
         } else {
             benchmarkFile << "\n=== NEW SESSION " << getCurrentTimestamp() << " ===\n";
-            benchmarkFile << "Operation,AvgTime(ms),MinTime(ms),MaxTime(ms),Count,Throughput(ops/sec)\n";
+            benchmarkFile << "Operation,Count,Avg(us),Min(us),P50(us),P90(us),P99(us),P99.9(us),P99.99(us),Max(us),Throughput(ops/sec)\n";
         }
     }
 }
@@ -80,51 +145,68 @@ double Benchmark::getElapsedTimeMs(const std::chrono::high_resolution_clock::tim
     return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
-Benchmark::Timer::Timer(const std::string &name)
-    : timerName(name), startTime(std::chrono::high_resolution_clock::now()) {
+Benchmark::Timer::Timer(Timing id)
+    : timing(id), startTime(TscClock::now()) {
 }
 
 Benchmark::Timer::~Timer() {
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double duration = std::chrono::duration<double, std::milli>(endTime - startTime).count();
-
-    Benchmark &benchmark = Benchmark::getInstance();
-    std::lock_guard<std::mutex> lock(benchmark.benchmarkMutex);
+    recordTiming(timing, TscClock::elapsed(startTime, TscClock::nowOrdered()));
+}
 
-    auto &timing = benchmark.timers[timerName];
-    timing.totalTime += duration;
-    timing.count++;
-    timing.minTime = std::min(timing.minTime, duration);
-    timing.maxTime = std::max(timing.maxTime, duration);
+Benchmark::ThreadMetrics *Benchmark::acquireThreadMetrics() {
+    std::lock_guard<std::mutex> lock(benchmarkMutex);
+    if (!freeThreadBlocks.empty()) {
+        ThreadMetrics *metrics = freeThreadBlocks.back();
+        freeThreadBlocks.pop_back();
+        return metrics;
+    }
+    threadBlocks.push_back(std::make_unique<ThreadMetrics>());
+    return threadBlocks.back().get();
 }
 
-void Benchmark::startTimer(const std::string &name) {
+void Benchmark::releaseThreadMetrics(ThreadMetrics *metrics) {
     std::lock_guard<std::mutex> lock(benchmarkMutex);
-    timers[name].startTime = std::chrono::high_resolution_clock::now();
+    freeThreadBlocks.push_back(metrics);
 }
 
-void Benchmark::endTimer(const std::string &name) {
-    auto endTime = std::chrono::high_resolution_clock::now();
+void Benchmark::mergeThreadMetrics(Totals &totals) {
+    for (const auto &metrics : threadBlocks) {
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            totals.counters[i] += metrics->counters[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < TIMING_COUNT; ++i) {
+            metrics->timings[i].addTo(totals.timings[i]);
+        }
+    }
+
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        totals.counters[i] -= baseline.counters[i];
+    }
+    for (size_t i = 0; i < TIMING_COUNT; ++i) {
+        totals.timings[i].subtract(baseline.timings[i]);
+    }
+}
 
+long Benchmark::getCounter(Counter id) {
     std::lock_guard<std::mutex> lock(benchmarkMutex);
-    auto &timing = timers[name];
+    auto totals = std::make_unique<Totals>();
+    mergeThreadMetrics(*totals);
+    return totals->counters[static_cast<size_t>(id)];
+}
 
-    if (timing.startTime.time_since_epoch().count() != 0) {
-        double duration = std::chrono::duration<double, std::milli>(endTime - timing.startTime).count();
-        timing.totalTime += duration;
-        timing.count++;
-        timing.minTime = std::min(timing.minTime, duration);
-        timing.maxTime = std::max(timing.maxTime, duration);
-        timing.startTime = std::chrono::high_resolution_clock::time_point{}; // Reset
-    }
+HistogramSnapshot Benchmark::getTiming(Timing id) {
+    std::lock_guard<std::mutex> lock(benchmarkMutex);
+    auto totals = std::make_unique<Totals>();
+    mergeThreadMetrics(*totals);
+    return totals->timings[static_cast<size_t>(id)];
 }
 
-void Benchmark::incrementCounter(const std::string &name) {
-    counters[name].fetch_add(1);
+const char* Benchmark::getTimingName(Timing id) {
+    return TIMING_NAMES[static_cast<size_t>(id)];
 }
 
-void Benchmark::addToCounter(const std::string &name, long value) {
-    counters[name].fetch_add(value);
+const char* Benchmark::getCounterName(Counter id) {
+    return COUNTER_NAMES[static_cast<size_t>(id)];
 }
 
 void Benchmark::recordThroughput(const std::string &operation, int count, double durationMs) {
@@ -146,42 +228,49 @@ void Benchmark::displayRealTimeStats() {
     std::lock_guard<std::mutex> lock(benchmarkMutex);
 
     double totalProgramTime = getElapsedTimeMs(programStart);
+    auto totals = std::make_unique<Totals>();
+    mergeThreadMetrics(*totals);
 
     std::cout << "\n📊 === REAL-TIME PERFORMANCE STATS ===\n";
     std::cout << "Program Runtime: " << std::fixed << std::setprecision(2) << totalProgramTime / 1000.0 << "s\n\n";
 
-    if (!counters.empty()) {
+    const auto &counters = totals->counters;
+    if (std::any_of(counters.begin(), counters.end(), [](long value) { return value != 0; })) {
         std::cout << "📈 Counters:\n";
-        for (const auto &[name, counter] : counters) {
-            long value = counter.load();
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            long value = counters[i];
+            if (value == 0)
+                continue;
             double rate = (totalProgramTime > 0) ? (value * 1000.0 / totalProgramTime) : 0;
-            std::cout << "  " << formatDisplayName(name) << ": " << value << " (" << std::fixed << std::setprecision(1) << rate << "/sec)\n";
+            std::cout << "  " << formatDisplayName(COUNTER_NAMES[i]) << ": " << value << " (" << std::fixed << std::setprecision(1) << rate << "/sec)\n";
         }
         std::cout << "\n";
     }
 
-    if (!timers.empty()) {
-        std::cout << "⏱️  Timing Statistics:\n";
+    const auto &timings = totals->timings;
+    if (std::any_of(timings.begin(), timings.end(), [](const HistogramSnapshot &h) { return h.count > 0; })) {
+        std::cout << "⏱️  Latency Distribution (us):\n";
         std::cout << std::left << std::setw(35) << "Operation"
-                  << std::setw(12) << "Count"
-                  << std::setw(12) << "Avg(ms)"
-                  << std::setw(12) << "Min(ms)"
-                  << std::setw(12) << "Max(ms)"
-                  << "Throughput(ops/sec)\n";
-        std::cout << std::string(95, '-') << "\n";
-
-        for (const auto &[name, timing] : timers) {
-            if (timing.count > 0) {
-                double avgTime = timing.totalTime / timing.count;
-                double throughput = (timing.totalTime > 0) ? (timing.count * 1000.0 / timing.totalTime) : 0;
-
-                std::cout << std::left << std::setw(35) << formatDisplayName(name)
-                          << std::setw(12) << timing.count
-                          << std::setw(12) << std::fixed << std::setprecision(3) << avgTime
-                          << std::setw(12) << std::fixed << std::setprecision(3) << timing.minTime
-                          << std::setw(12) << std::fixed << std::setprecision(3) << timing.maxTime
-                          << std::fixed << std::setprecision(1) << throughput << "\n";
+                  << std::setw(14) << "Count"
+                  << std::setw(14) << "Avg";
+        for (const char *label : QUANTILE_LABELS) {
+            std::cout << std::setw(14) << label;
+        }
+        std::cout << "Max\n";
+        std::cout << std::string(35 + 14 * 7 + 10, '-') << "\n";
+
+        for (size_t i = 0; i < TIMING_COUNT; ++i) {
+            const HistogramSnapshot &timing = timings[i];
+            if (timing.count == 0)
+                continue;
+
+            std::cout << std::left << std::setw(35) << formatDisplayName(TIMING_NAMES[i])
+                      << std::setw(14) << timing.count
+                      << std::setw(14) << std::fixed << std::setprecision(3) << toMicros(timing.mean());
+            for (double quantile : REPORTED_QUANTILES) {
+                std::cout << std::setw(14) << std::fixed << std::setprecision(3) << toMicros(timing.valueAt(quantile));
             }
+            std::cout << std::fixed << std::setprecision(3) << toMicros(timing.max()) << "\n";
         }
         std::cout << "\n";
     }
@@ -211,17 +300,35 @@ void Benchmark::logBenchmarks() {
 
     std::lock_guard<std::mutex> lock(benchmarkMutex);
 
-    for (const auto &[name, timing] : timers) {
-        if (timing.count > 0) {
-            double avgTime = timing.totalTime / timing.count;
-            double throughput = (timing.totalTime > 0) ? (timing.count * 1000.0 / timing.totalTime) : 0;
-
-            benchmarkFile << name << ","
-                          << std::fixed << std::setprecision(3) << avgTime << ","
-                          << std::fixed << std::setprecision(3) << timing.minTime << ","
-                          << std::fixed << std::setprecision(3) << timing.maxTime << ","
-                          << timing.count << ","
-                          << std::fixed << std::setprecision(1) << throughput << "\n";
+    double totalProgramTime = getElapsedTimeMs(programStart);
+    auto totals = std::make_unique<Totals>();
+    mergeThreadMetrics(*totals);
+
+    for (size_t i = 0; i < TIMING_COUNT; ++i) {
+        const HistogramSnapshot &timing = totals->timings[i];
+        if (timing.count == 0)
+            continue;
+
+        double throughput = (timing.sum > 0) ? (timing.count * 1e9 / TscClock::toNanos(timing.sum)) : 0;
+        benchmarkFile << TIMING_NAMES[i] << ","
+                      << timing.count << ","
+                      << std::fixed << std::setprecision(3) << toMicros(timing.mean()) << ","
+                      << std::fixed << std::setprecision(3) << toMicros(timing.min()) << ",";
+        for (double quantile : REPORTED_QUANTILES) {
+            benchmarkFile << std::fixed << std::setprecision(3) << toMicros(timing.valueAt(quantile)) << ",";
+        }
+        benchmarkFile << std::fixed << std::setprecision(3) << toMicros(timing.max()) << ","
+                      << std::fixed << std::setprecision(1) << throughput << "\n";
+    }
+
+    // Counters have no timings, only a count and a rate over the session
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        long value = totals->counters[i];
+        if (value != 0) {
+            double rate = (totalProgramTime > 0) ? (value * 1000.0 / totalProgramTime) : 0;
+            benchmarkFile << COUNTER_NAMES[i] << ","
+                          << value << ",,,,,,,,,"
+                          << std::fixed << std::setprecision(1) << rate << "\n";
         }
     }
 
@@ -230,8 +337,18 @@ void Benchmark::logBenchmarks() {
 
 void Benchmark::reset() {
     std::lock_guard<std::mutex> lock(benchmarkMutex);
-    timers.clear();
-    counters.clear();
+
+    // Thread blocks are written without locks, so rather than clearing them
+    // the current totals become the new zero
+    auto totals = std::make_unique<Totals>();
+    mergeThreadMetrics(*totals);
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        baseline.counters[i] += totals->counters[i];
+    }
+    for (size_t i = 0; i < TIMING_COUNT; ++i) {
+        baseline.timings[i].add(totals->timings[i]);
+    }
+
     throughputStats.clear();
     programStart = std::chrono::high_resolution_clock::now();
 }
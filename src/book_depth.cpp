@@ -0,0 +1,58 @@
+#include "order_book.hpp"
+#include "benchmark.hpp"
+
+void OrderBook::attachDepthFeed(SpscRing<DepthUpdate>* ring, SymbolId symbol) {
+    depthRing = ring;
+    depthSymbol = symbol;
+}
+
+// One record per level an operation touched, carrying the level's new total,
+// so the cost of the feed is bounded by the levels changed, not the orders
+void OrderBook::depthChanged(Side side, Price price, Quantity quantity) {
+    if (depthRing == nullptr) {
+        return;
+    }
+    pushDepth(DepthUpdate{0, price, quantity, depthSymbol, DepthUpdateKind::LEVEL, side});
+    ++depthSinceSnapshot;
+}
+
+// A dropped record still takes a sequence number so the consumer sees the
+// gap. Once one is dropped the rest are too until the resync snapshot,
+// which replaces them all anyway. Trades are not part of the snapshot, so
+// they are not held back while it is pending, but a trade that doesn't fit
+// is lost like any other record. The feed is market data only; order owners
+// get their fills through the shard's results.
+void OrderBook::pushDepth(const DepthUpdate& update) {
+    DepthUpdate record = update;
+    record.sequence = ++depthSequence;
+    bool held = depthResync && record.kind != DepthUpdateKind::TRADE;
+    if (held || !depthRing->tryPush(record)) {
+        depthResync = true;
+        BENCHMARK_COUNT(Counter::DEPTH_UPDATES_DROPPED);
+        return;
+    }
+    BENCHMARK_COUNT(Counter::DEPTH_UPDATES);
+}
+
+// RESET followed by the best depthSnapshotLevels levels of each side. Only
+// sent when the whole snapshot fits in the ring, otherwise it is retried at
+// the end of the next operation.
+void OrderBook::publishDepthSnapshot() {
+    if (depthRing->freeSlots() < 1 + 2 * depthSnapshotLevels) {
+        return;
+    }
+
+    depthResync = false;
+    depthSinceSnapshot = 0;
+    pushDepth(DepthUpdate{0, 0, 0, depthSymbol, DepthUpdateKind::RESET, Side::BUY});
+
+    auto sendSide = [&](const BookSide& book, Side side) {
+        size_t sent = 0;
+        book.forEachLevel([&](Price price, const OrderQueue& level) {
+            pushDepth(DepthUpdate{0, price, level.totalQuantity(), depthSymbol, DepthUpdateKind::LEVEL, side});
+            return ++sent < depthSnapshotLevels;
+        });
+    };
+    sendSide(bids, Side::BUY);
+    sendSide(asks, Side::SELL);
+}
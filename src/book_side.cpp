@@ -0,0 +1,93 @@
+#include "book_side.hpp"
+
+BookSide::BookSide(Side side_, const BookConfig& config, Price center)
+    : side(side_),
+      useLadder(config.backend == BookBackend::LADDER && config.ladderLevels > 0) {
+    if (useLadder) {
+        ladder.resize(config.ladderLevels);
+        occupied = OccupancyBitmap(config.ladderLevels);
+        base = center - static_cast<Price>(config.ladderLevels / 2);
+    }
+}
+
+bool BookSide::inWindow(Price price) const {
+    return useLadder && price >= base && price < base + static_cast<Price>(ladder.size());
+}
+
+// Slot 0 is always the most aggressive price of the window: the lowest price
+// for asks and the highest for bids, so the best level is the first set bit.
+size_t BookSide::slotFor(Price price) const {
+    if (side == Side::SELL) {
+        return static_cast<size_t>(price - base);
+    }
+    return static_cast<size_t>(base + static_cast<Price>(ladder.size()) - 1 - price);
+}
+
+Price BookSide::priceAt(size_t slot) const {
+    if (side == Side::SELL) {
+        return base + static_cast<Price>(slot);
+    }
+    return base + static_cast<Price>(ladder.size()) - 1 - static_cast<Price>(slot);
+}
+
+bool BookSide::better(Price a, Price b) const {
+    return (side == Side::SELL) ? (a < b) : (a > b);
+}
+
+BookSide::Level& BookSide::level(Price price) {
+    if (useLadder && empty() && !inWindow(price)) {
+        recenter(price);
+    }
+
+    if (inWindow(price)) {
+        size_t slot = slotFor(price);
+        if (!occupied.test(slot)) {
+            occupied.set(slot);
+            ++ladderCount;
+        }
+        return ladder[slot];
+    }
+    return overflow[price];
+}
+
+BookSide::Level* BookSide::best(Price& price) {
+    Level* bestLevel = nullptr;
+
+    if (ladderCount > 0) {
+        size_t slot = occupied.findFirst();
+        price = priceAt(slot);
+        bestLevel = &ladder[slot];
+    }
+
+    if (!overflow.empty()) {
+        auto& [overflowPrice, queue] = (side == Side::SELL) ? *overflow.begin() : *overflow.rbegin();
+        if (bestLevel == nullptr || better(overflowPrice, price)) {
+            price = overflowPrice;
+            bestLevel = &queue;
+        }
+    }
+
+    return bestLevel;
+}
+
+void BookSide::erase(Price price) {
+    if (inWindow(price)) {
+        size_t slot = slotFor(price);
+        if (occupied.test(slot)) {
+            occupied.clear(slot);
+            --ladderCount;
+        }
+        return;
+    }
+    overflow.erase(price);
+}
+
+bool BookSide::empty() const {
+    return ladderCount == 0 && overflow.empty();
+}
+
+// Only called while the whole side is empty, so no level can be referenced
+// by an in-progress match and no price can end up in both containers.
+void BookSide::recenter(Price center) {
+    base = center - static_cast<Price>(ladder.size() / 2);
+}
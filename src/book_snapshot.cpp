@@ -0,0 +1,73 @@
+#include "order_book.hpp"
+#include "snapshot.hpp"
+#include <cstring>
+
+namespace {
+
+void appendOrder(std::vector<char>& out, const Order& order) {
+    SnapshotOrder record = toSnapshotOrder(order);
+    const char* bytes = reinterpret_cast<const char*>(&record);
+    out.insert(out.end(), bytes, bytes + sizeof(record));
+}
+
+}
+
+size_t OrderBook::saveSnapshot(SymbolId symbol, std::vector<char>& out) const {
+    // Every pooled node is a resting or STOP order. ICEBERG slices carry the
+    // iceberg's remaining size themselves, so no tracking entries are written.
+    size_t headerOffset = out.size();
+    out.reserve(out.size() + sizeof(SnapshotBookHeader) + pool.inUse() * sizeof(SnapshotOrder));
+    out.resize(out.size() + sizeof(SnapshotBookHeader));
+
+    SnapshotBookHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.symbol = symbol;
+    header.lastTradedPrice = getLastTradedPrice();
+
+    // Levels best to worst and each level front to back, so loading them in
+    // file order rebuilds the same price-time priority
+    auto saveLevel = [&](Price, const OrderQueue& queue) {
+        for (NodeIndex index = queue.front(); index != NULL_NODE; index = pool[index].next) {
+            appendOrder(out, pool[index].order);
+            ++header.restingCount;
+        }
+    };
+    asks.forEachLevel(saveLevel);
+    bids.forEachLevel(saveLevel);
+
+    for (const auto* stopBook : {&stopAsks, &stopBids}) {
+        for (const auto& [triggerPrice, queue] : *stopBook) {
+            for (NodeIndex index = queue.front(); index != NULL_NODE; index = pool[index].next) {
+                appendOrder(out, pool[index].order);
+                ++header.stopCount;
+            }
+        }
+    }
+
+    std::memcpy(out.data() + headerOffset, &header, sizeof(header));
+    return header.restingCount + header.stopCount + header.icebergCount;
+}
+
+void OrderBook::loadSnapshot(const SnapshotBookHeader& header, const SnapshotOrder* orders) {
+    const SnapshotOrder* record = orders;
+
+    for (uint32_t i = 0; i < header.restingCount; ++i) {
+        addToBook(fromSnapshotOrder(*record++));
+    }
+    for (uint32_t i = 0; i < header.stopCount; ++i) {
+        addToStopBook(fromSnapshotOrder(*record++));
+    }
+    // Snapshots written before slices carried their reserve list a tracking
+    // entry per iceberg with the remaining size; fold it into the slice
+    for (uint32_t i = 0; i < header.icebergCount; ++i) {
+        Order tracked = fromSnapshotOrder(*record++);
+        NodeIndex index = orderIndex.find(tracked.id);
+        if (index != NULL_NODE) {
+            pool[index].order.totalQuantity = tracked.totalQuantity;
+        }
+    }
+
+    setLastTradedPrice(header.lastTradedPrice);
+    market.lastTrade = header.lastTradedPrice;
+    publishMarketData();
+}
@@ -0,0 +1,167 @@
+#include "order_book.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <algorithm>
+
+namespace {
+
+bool isStopOrder(const Order& order) {
+    return order.type == OrderType::STOP_LIMIT || order.type == OrderType::STOP_MARKET;
+}
+
+// Visible ICEBERG slices rest as LIMIT orders but keep the parent's display size
+bool isIcebergSlice(const Order& order) {
+    return !isStopOrder(order) && order.displayQuantity > 0;
+}
+
+}
+
+// Removes a node from whichever level it is linked into and frees it
+void OrderBook::unlinkOrder(NodeIndex index) {
+    const Order& order = pool[index].order;
+
+    if (isStopOrder(order)) {
+        auto& stopBook = (order.side == Side::SELL) ? stopAsks : stopBids;
+        auto levelIt = stopBook.find(order.triggerPrice);
+        levelIt->second.remove(pool, index);
+        if (levelIt->second.empty()) {
+            stopBook.erase(levelIt);
+        }
+    } else {
+        BookSide& book = (order.side == Side::BUY) ? bids : asks;
+        OrderQueue& queue = book.level(order.price);
+        queue.remove(pool, index);
+        depthChanged(order.side, order.price, queue.totalQuantity());
+        if (queue.empty()) {
+            book.erase(order.price);
+        }
+    }
+
+    orderIndex.erase(order.id);
+    pool.release(index);
+}
+
+OrderQueue& OrderBook::levelOf(const Order& order) {
+    if (isStopOrder(order)) {
+        auto& stopBook = (order.side == Side::SELL) ? stopAsks : stopBids;
+        return stopBook.find(order.triggerPrice)->second;
+    }
+    BookSide& book = (order.side == Side::BUY) ? bids : asks;
+    return book.level(order.price);
+}
+
+bool OrderBook::cancel(int orderId, int userId) {
+    NodeIndex index = orderIndex.find(orderId);
+    if (index == NULL_NODE || pool[index].order.userId != userId) {
+        BENCHMARK_COUNT(Counter::CANCELS_REJECTED);
+        reportRejected(OrderAction::CANCEL, orderId, userId, RejectReason::UNKNOWN_ORDER);
+        return false;
+    }
+
+    Order cancelled = pool[index].order;
+    unlinkOrder(index);
+
+    // The slice carries the iceberg's remaining size, so log it as the iceberg
+    if (isIcebergSlice(cancelled)) {
+        cancelled.type = OrderType::ICEBERG;
+    }
+
+    Logger::getInstance().logCancelledOrder(cancelled, instrument);
+    BENCHMARK_COUNT(Counter::ORDERS_CANCELLED);
+    publishMarketData();
+
+    if (wantsReport(userId)) {
+        ExecutionReport report = makeExecutionReport(ExecutionKind::CANCELLED, cancelled);
+        report.action = OrderAction::CANCEL;
+        pushReport(report);
+    }
+    return true;
+}
+
+bool OrderBook::modify(int orderId, int userId, Price newPrice, Quantity newQuantity) {
+    NodeIndex index = orderIndex.find(orderId);
+    if (index == NULL_NODE || pool[index].order.userId != userId) {
+        BENCHMARK_COUNT(Counter::MODIFIES_REJECTED);
+        reportRejected(OrderAction::MODIFY, orderId, userId, RejectReason::UNKNOWN_ORDER);
+        return false;
+    }
+
+    // The amended order must pass the same checks as a new one: a LIMIT
+    // re-entered at price 0 would be matched as if it had no limit and sweep
+    // the other side of the book
+    Order& resting = pool[index].order;
+    bool priced = resting.type != OrderType::STOP_MARKET;
+    if (newQuantity <= 0 || (priced && newPrice <= 0)) {
+        BENCHMARK_COUNT(Counter::MODIFIES_REJECTED);
+        reportRejected(OrderAction::MODIFY, orderId, userId,
+                       newQuantity <= 0 ? RejectReason::INVALID_QUANTITY : RejectReason::INVALID_PRICE);
+        return false;
+    }
+    if (!priced) {
+        newPrice = 0;  // STOP_MARKET orders have no limit price to amend
+    }
+
+    // An ICEBERG slice's size is the whole remaining iceberg, not the slice
+    bool iceberg = isIcebergSlice(resting);
+    Quantity currentQuantity = iceberg ? resting.totalQuantity : resting.quantity;
+
+    if (newPrice == resting.price && newQuantity <= currentQuantity) {
+        // Same price and no size increase: amend in place, keep time priority
+        Quantity visible = resting.quantity;
+        if (iceberg) {
+            resting.totalQuantity = newQuantity;
+            resting.quantity = std::min(resting.quantity, newQuantity);
+        } else {
+            resting.quantity = newQuantity;
+        }
+        OrderQueue& level = levelOf(resting);
+        level.reduce(visible - resting.quantity);
+        if (!isStopOrder(resting)) {
+            depthChanged(resting.side, resting.price, level.totalQuantity());
+        }
+        publishMarketData();
+
+        Logger::getInstance().logModifiedOrder(resting, instrument);
+        BENCHMARK_COUNT(Counter::ORDERS_MODIFIED);
+        if (wantsReport(userId)) {
+            ExecutionReport report = makeExecutionReport(ExecutionKind::MODIFIED, resting);
+            report.action = OrderAction::MODIFY;
+            report.quantity = newQuantity;
+            report.remaining = newQuantity;
+            report.keptPriority = true;
+            pushReport(report);
+        }
+        return true;
+    }
+
+    // Price change or size increase: the order loses time priority and
+    // re-enters the book as if it had just been submitted
+    Order replacement = resting;
+    if (iceberg) {
+        replacement.type = OrderType::ICEBERG;
+        replacement.totalQuantity = newQuantity;
+        replacement.displayQuantity = std::min(replacement.displayQuantity, newQuantity);
+    }
+    replacement.price = newPrice;
+    replacement.quantity = newQuantity;
+    unlinkOrder(index);
+
+    Logger::getInstance().logModifiedOrder(replacement, instrument);
+    BENCHMARK_COUNT(Counter::ORDERS_MODIFIED);
+    if (wantsReport(userId)) {
+        ExecutionReport report = makeExecutionReport(ExecutionKind::MODIFIED, replacement);
+        report.action = OrderAction::MODIFY;
+        report.remaining = newQuantity;
+        pushReport(report);
+    }
+
+    if (isStopOrder(replacement)) {
+        addToStopBook(replacement);
+        publishMarketData();
+        return true;
+    }
+
+    // Re-submitted like a new order because it may cross the spread and trade
+    match(replacement);
+    return true;
+}
@@ -0,0 +1,134 @@
+#include "console_reporter.hpp"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr size_t REPORT_BATCH = 256;
+
+const char* sideName(Side side) {
+    return side == Side::BUY ? "BUY" : "SELL";
+}
+
+}  // namespace
+
+ConsoleReporter::ConsoleReporter(Engine& engine_)
+    : engine(engine_), batch(REPORT_BATCH) {}
+
+ConsoleReporter::~ConsoleReporter() {
+    stop();
+}
+
+void ConsoleReporter::start() {
+    running = true;
+    thread = std::thread(&ConsoleReporter::run, this);
+}
+
+void ConsoleReporter::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// Nobody is waiting on the console, so an idle reporter sleeps rather than
+// spins; a report waits at most a millisecond to be printed
+void ConsoleReporter::run() {
+    while (true) {
+        bool stopping = !running.load();
+        size_t count = engine.pollExecutions(batch.data(), batch.size());
+        if (count > 0) {
+            std::string text;
+            for (size_t i = 0; i < count; ++i) {
+                text += render(batch[i], engine.getInstrument(batch[i].symbol));
+            }
+            std::cout << text << std::flush;
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+std::string ConsoleReporter::render(const ExecutionReport& report, const Instrument& instrument) {
+    std::ostringstream out;
+    double price = instrument.toPrice(report.price);
+    double quantity = instrument.toQuantity(report.quantity);
+
+    switch (report.kind) {
+        case ExecutionKind::ACCEPTED:
+            out << "[STOP] Your " << (report.type == OrderType::STOP_LIMIT ? "STOP-LIMIT" : "STOP-MARKET")
+                << " " << sideName(report.side) << " order placed. Will trigger when price "
+                << (report.side == Side::BUY ? ">=" : "<=") << " $" << instrument.toPrice(report.reference) << "\n";
+            break;
+        case ExecutionKind::FILLED:
+        case ExecutionKind::PARTIALLY_FILLED:
+            if (report.maker) {
+                out << "[MATCH] Your resting " << sideName(report.side) << " order executed: " << quantity
+                    << " units @ $" << price << "\n";
+            } else {
+                out << (report.side == Side::BUY ? "[MATCH] You bought " : "[MATCH] You sold ") << quantity
+                    << " units @ $" << price << "\n";
+            }
+            if (report.kind == ExecutionKind::FILLED && report.type == OrderType::ICEBERG) {
+                out << "[ICEBERG COMPLETE] Your ICEBERG order fully executed!\n";
+            }
+            break;
+        case ExecutionKind::RESTED:
+            if (report.type == OrderType::ICEBERG) {
+                out << "[ICEBERG] Your ICEBERG " << sideName(report.side) << " order placed. Showing " << quantity
+                    << " of " << instrument.toQuantity(report.remaining) << " shares @ $" << price << "\n";
+            } else {
+                out << "[RESTING] Your " << sideName(report.side) << " order for " << quantity << " units @ $"
+                    << price << " is now in the order book waiting for a match.\n";
+            }
+            break;
+        case ExecutionKind::TRIGGERED:
+            out << "[STOP TRIGGERED] Your STOP " << sideName(report.side) << " triggered at $"
+                << instrument.toPrice(report.reference) << " -> executing "
+                << (report.type == OrderType::MARKET ? "MARKET" : "LIMIT") << " order\n";
+            break;
+        case ExecutionKind::REJECTED:
+            if (report.reason == RejectReason::PRICE_COLLAR) {
+                out << "[ORDER REJECTED] Your STOP " << sideName(report.side) << " limit $" << price
+                    << " exceeds maximum allowed deviation from market price $" << instrument.toPrice(report.reference)
+                    << " (exchange price collar violation)\n";
+            } else {
+                out << (report.action == OrderAction::CANCEL ? "[CANCEL REJECTED] Order #" : "[MODIFY REJECTED] Order #")
+                    << report.orderId;
+                if (report.reason == RejectReason::INVALID_QUANTITY) {
+                    out << " needs a positive quantity\n";
+                } else if (report.reason == RejectReason::INVALID_PRICE) {
+                    out << " needs a positive price\n";
+                } else {
+                    out << " is not resting in the book\n";
+                }
+            }
+            break;
+        case ExecutionKind::REFILLED:
+            out << "[ICEBERG REFILL] " << quantity << " more shares now visible @ $" << price
+                << " (remaining: " << instrument.toQuantity(report.remaining) << ")\n";
+            break;
+        case ExecutionKind::CANCELLED:
+            if (report.action == OrderAction::CANCEL) {
+                out << "[CANCELLED] Your order #" << report.orderId << " was removed from the book\n";
+            } else {
+                out << "[UNFILLED] " << quantity << " units of your MARKET " << sideName(report.side)
+                    << " order found no liquidity and were cancelled\n";
+            }
+            break;
+        case ExecutionKind::MODIFIED:
+            if (report.keptPriority) {
+                out << "[MODIFIED] Your order #" << report.orderId << " now has " << quantity
+                    << " units and keeps its place in the queue\n";
+            } else {
+                out << "[MODIFIED] Your order #" << report.orderId << " re-entered at $" << price << " for "
+                    << instrument.toQuantity(report.remaining) << " units (time priority reset)\n";
+            }
+            break;
+    }
+    return out.str();
+}
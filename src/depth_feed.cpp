@@ -0,0 +1,63 @@
+#include "depth_feed.hpp"
+#include "benchmark.hpp"
+
+// A gap means records were dropped, so levels may be missing or stale until
+// the book's next depth snapshot; until then the view keeps what it has but
+// reports itself as not synced
+void DepthView::apply(const DepthUpdate& update) {
+    if (update.sequence != nextSequence && synced) {
+        synced = false;
+        ++levels.gaps;
+        BENCHMARK_COUNT(Counter::DEPTH_GAPS);
+    }
+    if (update.kind == DepthUpdateKind::RESET) {
+        bids.clear();
+        asks.clear();
+        synced = true;
+    }
+    nextSequence = update.sequence + 1;
+    ++levels.updates;
+
+    if (update.kind == DepthUpdateKind::TRADE) {
+        return;
+    }
+    changed = true;
+    if (update.kind != DepthUpdateKind::LEVEL) {
+        return;
+    }
+
+    auto setLevel = [&](auto& side) {
+        if (update.quantity > 0) {
+            side[update.price] = update.quantity;
+        } else {
+            side.erase(update.price);
+        }
+    };
+    if (update.side == Side::BUY) {
+        setLevel(bids);
+    } else {
+        setLevel(asks);
+    }
+}
+
+void DepthView::publish() {
+    if (!changed) {
+        return;
+    }
+    changed = false;
+
+    auto copyLevels = [](const auto& side, DepthLevel* out, uint32_t& count) {
+        count = 0;
+        for (auto it = side.begin(); it != side.end() && count < DEPTH_VIEW_LEVELS; ++it) {
+            out[count++] = DepthLevel{it->first, it->second};
+        }
+    };
+    copyLevels(bids, levels.bids, levels.bidCount);
+    copyLevels(asks, levels.asks, levels.askCount);
+    levels.synced = synced ? 1 : 0;
+    published.store(levels);
+}
+
+DepthLevels DepthView::read() const {
+    return published.load();
+}
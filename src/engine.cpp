@@ -1,63 +1,555 @@
 #include "engine.hpp"
 #include "benchmark.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
 
-Engine::Engine(size_t workerCount) : running(false), pool(workerCount), orderBook() {}
+Engine::Engine(const EngineConfig& config_)
+    : config(config_),
+      ingress(config_.queueCapacity),
+      dispatcherParker(config_.spinIterations),
+      publisherParker(config_.spinIterations),
+      running(false),
+      publishing(false),
+      orderIdCounter(10000),
+      sequencedCount(0),
+      publishedSequence(0) {
+    size_t shardCount = std::max<size_t>(1, std::min(config.shardCount, config.instruments.size()));
+
+    // A journal or snapshot only loads into the same symbols, tick sizes and lot sizes
+    layoutHash = 1469598103934665603ull;
+    for (const Instrument& instrument : config.instruments) {
+        std::string text = instrument.symbol + "|" + std::to_string(instrument.tickSize) + "|" + std::to_string(instrument.lotSize) + ";";
+        for (unsigned char c : text) {
+            layoutHash = (layoutHash ^ c) * 1099511628211ull;
+        }
+    }
+
+    if (!config.snapshot.path.empty()) {
+        snapshotWriter = std::make_unique<SnapshotWriter>(config.snapshot.path, layoutHash, shardCount);
+    }
+
+    if (!config.trace.path.empty()) {
+        trace = std::make_unique<LatencyTrace>(config.trace);
+        if (!trace->isOpen()) {
+            trace.reset();
+        }
+    }
+
+    if (!config.marketDataFeed.name.empty()) {
+        marketDataFeed = std::make_unique<ShmPublisher>(config.marketDataFeed, config.instruments);
+        std::string error;
+        if (!marketDataFeed->open(error)) {
+            std::cerr << "Warning: " << error << "\n";
+            marketDataFeed.reset();
+        }
+    }
+
+    for (size_t i = 0; i < shardCount; ++i) {
+        ShardConfig shardConfig;
+        shardConfig.cpu = (i < config.cpuAffinity.size()) ? config.cpuAffinity[i] : -1;
+        shardConfig.inboxCapacity = config.queueCapacity;
+        shardConfig.resultCapacity = config.queueCapacity;
+        shardConfig.depthCapacity = config.queueCapacity;
+        shardConfig.batchSize = config.dispatchBatchSize;
+        shardConfig.waitStrategy = config.waitStrategy;
+        shardConfig.spinIterations = config.spinIterations;
+        shardConfig.gatewayFills = !config.gateway.shmName.empty() || !config.gateway.socketPath.empty();
+        shards.push_back(std::make_unique<Shard>(i, shardConfig, publisherParker, snapshotWriter.get()));
+    }
+
+    for (size_t symbol = 0; symbol < config.instruments.size(); ++symbol) {
+        size_t shardIndex = symbol % shardCount;
+        Shard* shard = shards[shardIndex].get();
+        shard->addBook(static_cast<SymbolId>(symbol), config.instruments[symbol], config.bookConfig);
+        shardForSymbol.push_back(shardIndex);
+        books.push_back(shard->getBook(static_cast<SymbolId>(symbol)));
+        depthViews.push_back(std::make_unique<DepthView>());
+    }
+
+    if (!config.gateway.shmName.empty() || !config.gateway.socketPath.empty()) {
+        gateway = std::make_unique<Gateway>(config.gateway, *this);
+        std::string error;
+        if (!gateway->open(error)) {
+            std::cerr << "Warning: " << error << "\n";
+            gateway.reset();
+        }
+    }
+}
 
 Engine::~Engine() {
     stop();
 }
 
+bool Engine::recover(RecoveryStats& stats, std::string& error) {
+    // The shard threads aren't running yet, so the books are loaded directly
+    // on this thread
+    if (!config.snapshot.path.empty() && std::filesystem::exists(config.snapshot.path)) {
+        auto start = std::chrono::steady_clock::now();
+        if (!loadSnapshot(stats, error)) {
+            return false;
+        }
+        stats.snapshotLoadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        lastSequence = stats.snapshotSequence;
+    }
+
+    if (!config.journal.path.empty()) {
+        journal = std::make_unique<Journal>(config.journal, layoutHash);
+        if (!journal->open(error)) {
+            journal.reset();
+            return false;
+        }
+
+        // Only the tail after the snapshot is replayed. Replayed requests
+        // were already logged by the run that journaled them.
+        Logger::getInstance().setEnabled(false);
+        auto start = std::chrono::steady_clock::now();
+        journal->replay([&](const Order& order) {
+            if (order.sequence > stats.snapshotSequence && order.symbol < shardForSymbol.size()) {
+                shards[shardForSymbol[order.symbol]]->replay(order);
+                ++stats.requests;
+            }
+        });
+        stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Logger::getInstance().setEnabled(true);
+
+        lastSequence = std::max(lastSequence, journal->getLastSequence());
+        if (journal->getMaxOrderId() >= orderIdCounter.load()) {
+            orderIdCounter = journal->getMaxOrderId() + 1;
+        }
+    }
+
+    sequencedCount = lastSequence;
+    publishedSequence = lastSequence;
+    return true;
+}
+
+bool Engine::loadSnapshot(RecoveryStats& stats, std::string& error) {
+    std::vector<char> data;
+    if (!readSnapshotFile(config.snapshot.path, layoutHash, data, error)) {
+        return false;
+    }
+
+    SnapshotFileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    // Every section is a multiple of 8 bytes, so records are read in place
+    const char* cursor = data.data() + sizeof(header);
+    const char* end = data.data() + data.size();
+    for (uint32_t i = 0; i < header.bookCount; ++i) {
+        if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(SnapshotBookHeader))) {
+            error = config.snapshot.path + " is truncated";
+            return false;
+        }
+        SnapshotBookHeader bookHeader;
+        std::memcpy(&bookHeader, cursor, sizeof(bookHeader));
+        cursor += sizeof(bookHeader);
+
+        size_t orderCount = static_cast<size_t>(bookHeader.restingCount) + bookHeader.stopCount + bookHeader.icebergCount;
+        if (static_cast<size_t>(end - cursor) < orderCount * sizeof(SnapshotOrder) || bookHeader.symbol >= books.size()) {
+            error = config.snapshot.path + " is truncated or corrupt";
+            return false;
+        }
+        books[bookHeader.symbol]->loadSnapshot(bookHeader, reinterpret_cast<const SnapshotOrder*>(cursor));
+        cursor += orderCount * sizeof(SnapshotOrder);
+        stats.snapshotOrders += orderCount;
+    }
+
+    stats.snapshotSequence = header.sequence;
+    if (header.nextOrderId > orderIdCounter.load()) {
+        orderIdCounter = static_cast<int>(header.nextOrderId);
+    }
+    return true;
+}
+
 void Engine::start() {
     running = true;
+    publishing = true;
+    if (snapshotWriter) {
+        snapshotWriter->start();
+    }
+    publisherThread = std::thread(&Engine::publishResults, this);
+    for (auto& shard : shards) {
+        shard->start();
+    }
     dispatcherThread = std::thread(&Engine::dispatchOrders, this);
+    if (gateway) {
+        gateway->start();
+    }
 }
 
+// Stages stop front to back, each draining what the previous one handed it
 void Engine::stop() {
+    if (gateway) {
+        gateway->stop();
+    }
+
     running = false;
-    cv.notify_all();
+    dispatcherParker.wakeAll();
 
     if (dispatcherThread.joinable())
         dispatcherThread.join();
+
+    if (journal) {
+        journal->close();
+    }
+
+    for (auto& shard : shards) {
+        shard->stop();
+    }
+
+    publishing = false;
+    publisherParker.wakeAll();
+
+    if (publisherThread.joinable())
+        publisherThread.join();
+
+    if (marketDataFeed) {
+        marketDataFeed->close();
+    }
+
+    if (gateway) {
+        gateway->close();
+    }
+
+    if (snapshotWriter) {
+        snapshotWriter->stop();
+    }
 }
 
 void Engine::submitOrder(const Order& order) {
-    BENCHMARK_TIMER("Order_Submission");
-    Benchmark::getInstance().incrementCounter("Orders_Submitted");
+    BENCHMARK_TIMER(Timing::ORDER_SUBMISSION);
+    BENCHMARK_COUNT(Counter::ORDERS_SUBMITTED);
     
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        orderQueue.push(order);
+    // A full ring is backpressure: wait for the dispatcher to make room
+    for (unsigned spins = 0; !ingress.tryPush(order); ++spins) {
+        if (spins < 64) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    dispatcherParker.notify();
+}
+
+void Engine::submitOrders(const Order* orders, size_t count) {
+    BENCHMARK_TIMER(Timing::ORDER_SUBMISSION);
+    BENCHMARK_ADD(Counter::ORDERS_SUBMITTED, static_cast<long>(count));
+
+    unsigned spins = 0;
+    while (count > 0) {
+        size_t pushed = ingress.tryPushBatch(orders, count);
+        if (pushed > 0) {
+            orders += pushed;
+            count -= pushed;
+            spins = 0;
+            continue;
+        }
+
+        // Full: let the dispatcher see what is already queued and make room
+        dispatcherParker.notify();
+        if (spins++ < 64) {
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    dispatcherParker.notify();
+}
+
+void Engine::cancelOrder(int orderId, int userId, SymbolId symbol) {
+    Order request{};
+    request.id = orderId;
+    request.userId = userId;
+    request.symbol = symbol;
+    request.action = OrderAction::CANCEL;
+    request.timestamp = TscClock::now();
+    submitOrder(request);
+}
+
+void Engine::modifyOrder(int orderId, Price newPrice, Quantity newQuantity, int userId, SymbolId symbol) {
+    Order request{};
+    request.id = orderId;
+    request.userId = userId;
+    request.symbol = symbol;
+    request.price = newPrice;
+    request.quantity = newQuantity;
+    request.action = OrderAction::MODIFY;
+    request.timestamp = TscClock::now();
+    submitOrder(request);
+}
+
+bool Engine::requestSnapshot() {
+    if (!snapshotWriter) {
+        return false;
+    }
+    Order request{};
+    request.action = OrderAction::SNAPSHOT;
+    request.timestamp = TscClock::now();
+    submitOrder(request);
+    return true;
+}
+
+uint64_t Engine::getLastSnapshotSequence() const {
+    return snapshotWriter ? snapshotWriter->getLastWrittenSequence() : 0;
+}
+
+int Engine::nextOrderId() {
+    return orderIdCounter.fetch_add(1);
+}
+
+int Engine::reserveOrderIds(int count) {
+    return orderIdCounter.fetch_add(count);
+}
+
+OrderBook& Engine::getOrderBook(SymbolId symbol) {
+    return *books.at(symbol);
+}
+
+DepthLevels Engine::getDepth(SymbolId symbol) const {
+    return depthViews.at(symbol)->read();
+}
+
+size_t Engine::pollExecutions(ExecutionReport* out, size_t maxReports) {
+    size_t count = 0;
+    for (auto& shard : shards) {
+        count += shard->pollExecutions(out + count, maxReports - count);
     }
+    return count;
+}
+
+size_t Engine::getSymbolCount() const {
+    return books.size();
+}
 
-    cv.notify_one();
+const Instrument& Engine::getInstrument(SymbolId symbol) const {
+    return books.at(symbol)->getInstrument();
+}
+
+bool Engine::findSymbol(const std::string& name, SymbolId& symbol) const {
+    for (size_t i = 0; i < config.instruments.size(); ++i) {
+        if (config.instruments[i].symbol == name) {
+            symbol = static_cast<SymbolId>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Engine::getShardCount() const {
+    return shards.size();
+}
+
+size_t Engine::getQueueDepth() const {
+    size_t depth = ingress.sizeApprox();
+    for (const auto& shard : shards) {
+        depth += shard->getInboxDepth();
+    }
+    return depth;
 }
 
-OrderBook& Engine::getOrderBook() {
-    return orderBook;
+uint64_t Engine::getSequencedCount() const {
+    return sequencedCount.load(std::memory_order_relaxed);
 }
 
+uint64_t Engine::getPublishedSequence() const {
+    return publishedSequence.load(std::memory_order_relaxed);
+}
+
+// The sequencer: the only thread that takes orders off the ingress ring and
+// the only producer of every shard inbox
 void Engine::dispatchOrders() {
-    while (running) {
-        Order order;
+    // One spare slot for a periodic snapshot request
+    std::vector<Order> batch(config.dispatchBatchSize + 1);
+    std::vector<bool> touched(shards.size(), false);
+    uint64_t sequence = lastSequence;
+    uint64_t sinceSnapshot = 0;
+    unsigned idleSpins = 0;
 
-        {
-            BENCHMARK_TIMER("Order_Queue_Wait");
-            std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        size_t count = ingress.tryPopBatch(batch.data(), config.dispatchBatchSize);
+        ingress.publishConsumerPosition();
 
-            cv.wait(lock, [&]() { return !orderQueue.empty() || !running; });
+        if (count == 0) {
+            // Producers stop before the engine does, so an empty ring after
+            // stop() means everything submitted has been dispatched
+            if (!running && ingress.empty())
+                break;
+
+            dispatcherParker.wait(config.waitStrategy, idleSpins,
+                                  [&]() { return !ingress.empty() || !running; });
+            continue;
+        }
+        idleSpins = 0;
+
+        Ticks now = TscClock::now();
+        size_t accepted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            Order& order = batch[i];
+            order.stages.dispatched = OrderStages::offset(order.timestamp, now);
+            BENCHMARK_TIMING(Timing::SUBMIT_TO_DISPATCH, order.stages.dispatched);
+
+            if (order.action == OrderAction::SNAPSHOT) {
+                // Not journaled: the snapshot itself is the record of this point
+                order.sequence = ++sequence;
+                order.id = orderIdCounter.load();
+                sinceSnapshot = 0;
+                batch[accepted++] = order;
+                continue;
+            }
+
+            // An unknown symbol still gets a sequence number so a shard can
+            // publish its rejection; it is never journaled, like a snapshot
+            order.sequence = ++sequence;
+            if (journal && order.symbol < shardForSymbol.size()) {
+                journal->append(order);
+            }
+            batch[accepted++] = order;
+            ++sinceSnapshot;
+        }
 
-            if (!running && orderQueue.empty())
+        if (snapshotWriter && config.snapshot.everyRequests > 0 && sinceSnapshot >= config.snapshot.everyRequests) {
+            Order request{};
+            request.action = OrderAction::SNAPSHOT;
+            request.timestamp = now;
+            request.sequence = ++sequence;
+            request.id = orderIdCounter.load();
+            sinceSnapshot = 0;
+            batch[accepted++] = request;
+        }
+
+        // Journal first: with the per-batch policy no book sees a request
+        // that isn't on disk yet
+        if (journal) {
+            journal->commit();
+        }
+
+        for (size_t i = 0; i < accepted; ++i) {
+            if (batch[i].action == OrderAction::SNAPSHOT) {
+                // Every shard copies its books at the same sequence point
+                for (size_t s = 0; s < shards.size(); ++s) {
+                    shards[s]->submit(batch[i]);
+                    touched[s] = true;
+                }
+                continue;
+            }
+            // No shard owns an unknown symbol; the first one rejects it
+            SymbolId symbol = batch[i].symbol;
+            size_t shardIndex = symbol < shardForSymbol.size() ? shardForSymbol[symbol] : 0;
+            shards[shardIndex]->submit(batch[i]);
+            touched[shardIndex] = true;
+        }
+        sequencedCount.store(sequence, std::memory_order_relaxed);
+
+        // Wake each shard once per batch rather than once per order
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (touched[s]) {
+                shards[s]->notify();
+                touched[s] = false;
+            }
+        }
+        BENCHMARK_ADD(Counter::ORDERS_DISPATCHED, static_cast<long>(count));
+    }
+}
+
+// The publish stage: the single consumer of every shard's result ring.
+// Results from one shard arrive in sequence order; results from different
+// shards interleave.
+void Engine::publishResults() {
+    std::vector<OrderResult> batch(config.dispatchBatchSize);
+    std::vector<DepthUpdate> depthBatch(config.dispatchBatchSize);
+    std::vector<uint64_t> lastSequence(shards.size(), 0);
+    unsigned idleSpins = 0;
+
+    auto anyResults = [&]() {
+        for (const auto& shard : shards) {
+            if (shard->hasResults() || shard->hasDepthUpdates())
+                return true;
+        }
+        return false;
+    };
+
+    while (true) {
+        size_t published = 0;
+        size_t depthApplied = 0;
+        for (size_t s = 0; s < shards.size(); ++s) {
+            // A book writes its depth records before the result of the same
+            // request, so the views are at least as new as the results below
+            size_t depthCount = shards[s]->pollDepth(depthBatch.data(), depthBatch.size());
+            for (size_t i = 0; i < depthCount; ++i) {
+                depthViews[depthBatch[i].symbol]->apply(depthBatch[i]);
+                if (marketDataFeed) {
+                    marketDataFeed->publish(depthBatch[i]);
+                }
+            }
+            depthApplied += depthCount;
+
+            size_t count = shards[s]->pollResults(batch.data(), batch.size());
+            if (count == 0)
+                continue;
+
+            Ticks now = TscClock::now();
+            for (size_t i = 0; i < count; ++i) {
+                const OrderResult& result = batch[i];
+                if (result.kind == OrderResultKind::FILL) {
+                    if (gateway) {
+                        gateway->onFill(result);
+                    }
+                    continue;
+                }
+                if (result.sequence <= lastSequence[s]) {
+                    BENCHMARK_COUNT(Counter::SEQUENCE_ORDER_VIOLATIONS);
+                }
+                lastSequence[s] = result.sequence;
+                if (!result.accepted) {
+                    BENCHMARK_COUNT(Counter::REQUESTS_REJECTED);
+                }
+
+                const OrderStages& stages = result.stages;
+                BENCHMARK_TIMING(Timing::DISPATCH_TO_PICKUP, TscClock::elapsed(stages.dispatched, stages.pickedUp));
+                BENCHMARK_TIMING(Timing::MATCH_TO_PUBLISH,
+                                 TscClock::elapsed(result.submitted + stages.matched, now));
+                BENCHMARK_TIMING(Timing::SUBMIT_TO_PUBLISH, TscClock::elapsed(result.submitted, now));
+                if (trace && trace->sampled(result.sequence)) {
+                    trace->write(result, now);
+                }
+                if (gateway) {
+                    gateway->onResult(result);
+                }
+            }
+
+            if (lastSequence[s] > publishedSequence.load(std::memory_order_relaxed)) {
+                publishedSequence.store(lastSequence[s], std::memory_order_relaxed);
+            }
+            published += count;
+        }
+
+        if (depthApplied > 0) {
+            for (auto& view : depthViews) {
+                view->publish();
+            }
+        }
+
+        if (published == 0 && depthApplied == 0) {
+            // Shards stop before the publisher, so nothing more can arrive
+            if (!publishing && !anyResults())
                 break;
 
-            order = orderQueue.front();
-            orderQueue.pop();
+            publisherParker.wait(config.waitStrategy, idleSpins,
+                                 [&]() { return anyResults() || !publishing; });
+            continue;
         }
+        idleSpins = 0;
 
-        Benchmark::getInstance().incrementCounter("Orders_Dispatched");
-        
-        pool.enqueue([this, order]() {
-            BENCHMARK_TIMER("Order_Processing");
-            orderBook.match(order);
-        });
+        BENCHMARK_ADD(Counter::RESULTS_PUBLISHED, static_cast<long>(published));
+    }
+
+    if (trace) {
+        trace->flush();
     }
 }
@@ -0,0 +1,37 @@
+#include "order_book.hpp"
+#include "benchmark.hpp"
+
+void OrderBook::attachExecutionSink(SpscRing<ExecutionReport>* ring, SymbolId symbol) {
+    executionRing = ring;
+    executionSymbol = symbol;
+}
+
+void OrderBook::attachFillSink(std::vector<Fill>* fills, int fromUserId) {
+    fillSink = fills;
+    fillUserBase = fromUserId;
+}
+
+// Matching never waits for whoever renders the reports
+void OrderBook::pushReport(ExecutionReport& report) {
+    report.symbol = executionSymbol;
+    if (!executionRing->tryPush(report)) {
+        BENCHMARK_COUNT(Counter::EXECUTION_REPORTS_DROPPED);
+        return;
+    }
+    BENCHMARK_COUNT(Counter::EXECUTION_REPORTS);
+}
+
+// A cancel or modify that found nothing to act on has no order to report
+// from, only the request
+void OrderBook::reportRejected(OrderAction action, int orderId, int userId, RejectReason reason) {
+    if (!wantsReport(userId)) {
+        return;
+    }
+    ExecutionReport report{};
+    report.kind = ExecutionKind::REJECTED;
+    report.orderId = orderId;
+    report.userId = userId;
+    report.action = action;
+    report.reason = reason;
+    pushReport(report);
+}
@@ -0,0 +1,500 @@
+#include "gateway.hpp"
+#include "engine.hpp"
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t REQUEST_BATCH = 256;            // Requests taken from one session per pass
+constexpr int ORDER_ID_BLOCK = 1024;             // Order ids reserved from the engine at a time
+constexpr size_t SOCKET_READ_BYTES = 64 * 1024;
+constexpr size_t SOCKET_OUTPUT_LIMIT = 64 * 1024;  // Responses buffered per socket before the ring backs up
+constexpr unsigned IDLE_SPINS = 10000;           // Empty passes before the thread waits in poll()
+
+GatewaySlotState slotState(const GatewaySlot& slot) {
+    return static_cast<GatewaySlotState>(slot.state.load(std::memory_order_acquire));
+}
+
+void setSlotState(GatewaySlot& slot, GatewaySlotState state) {
+    slot.state.store(static_cast<uint32_t>(state), std::memory_order_release);
+}
+
+}  // namespace
+
+Gateway::Gateway(const GatewayConfig& config_, Engine& engine_)
+    : config(config_), engine(engine_), batch(REQUEST_BATCH), readBuffer(sizeof(GatewayRequest) + SOCKET_READ_BYTES) {}
+
+Gateway::~Gateway() {
+    stop();
+    close();
+}
+
+bool Gateway::open(std::string& error) {
+    if (!config.shmName.empty()) {
+        mappedSize = sizeof(GatewaySegment);
+
+        // Clients of an earlier run keep their mapping of the old segment and
+        // see it as shut down; new ones find this one
+        shm_unlink(config.shmName.c_str());
+        int fd = shm_open(config.shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            error = "could not create shared memory " + config.shmName + ": " + std::strerror(errno);
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+            error = "could not size shared memory " + config.shmName + ": " + std::strerror(errno);
+            ::close(fd);
+            shm_unlink(config.shmName.c_str());
+            return false;
+        }
+        void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            error = "could not map shared memory " + config.shmName + ": " + std::strerror(errno);
+            shm_unlink(config.shmName.c_str());
+            return false;
+        }
+
+        // The segment starts zero-filled: every slot FREE, every ring empty
+        segment = static_cast<GatewaySegment*>(mapping);
+        segment->magic = GATEWAY_MAGIC;
+        segment->version = GATEWAY_VERSION;
+        segment->slotCount = GATEWAY_SHM_CLIENTS;
+        segment->symbolCount = static_cast<uint32_t>(engine.getSymbolCount());
+        for (size_t i = 0; i < GATEWAY_SHM_CLIENTS; ++i) {
+            GatewaySlot& slot = segment->slots[i];
+            sessions[i].responses = &slot.responses;
+            sessions[i].responsesDropped = &slot.responsesDropped;
+        }
+        segment->running.store(1, std::memory_order_release);
+    }
+
+    if (!config.socketPath.empty()) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (config.socketPath.size() >= sizeof(address.sun_path)) {
+            error = "socket path " + config.socketPath + " is too long";
+            return false;
+        }
+        std::strncpy(address.sun_path, config.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0) {
+            error = std::string("could not create socket: ") + std::strerror(errno);
+            return false;
+        }
+        ::unlink(config.socketPath.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, static_cast<int>(GATEWAY_SOCKET_CLIENTS)) != 0) {
+            error = "could not listen on " + config.socketPath + ": " + std::strerror(errno);
+            ::close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        for (size_t i = GATEWAY_SHM_CLIENTS; i < GATEWAY_MAX_SESSIONS; ++i) {
+            sessions[i].socketResponses = std::make_unique<GatewayResponseRing>();
+            sessions[i].responses = sessions[i].socketResponses.get();
+            sessions[i].responsesDropped = &sessions[i].socketDropped;
+        }
+    }
+    return true;
+}
+
+void Gateway::start() {
+    running = true;
+    thread = std::thread(&Gateway::run, this);
+}
+
+void Gateway::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (segment != nullptr) {
+        segment->running.store(0, std::memory_order_release);
+    }
+}
+
+// The publisher may still be routing responses until the engine has drained,
+// so the rings stay mapped until then; socket clients get what fits in one
+// last write
+void Gateway::close() {
+    for (size_t i = GATEWAY_SHM_CLIENTS; i < GATEWAY_MAX_SESSIONS; ++i) {
+        if (sessions[i].fd >= 0) {
+            flushSocket(sessions[i]);
+            closeSocket(sessions[i]);
+        }
+    }
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(config.socketPath.c_str());
+    }
+    if (segment != nullptr) {
+        for (size_t i = 0; i < GATEWAY_SHM_CLIENTS; ++i) {
+            sessions[i].userId.store(0, std::memory_order_release);
+        }
+        munmap(segment, mappedSize);
+        shm_unlink(config.shmName.c_str());
+        segment = nullptr;
+    }
+}
+
+// userIds encode the session index, so the publisher finds the session of a
+// result without a lookup table; the generation keeps a reused session from
+// receiving responses meant for the client before it
+int32_t Gateway::openSession(size_t index) {
+    Session& session = sessions[index];
+    ++session.generation;
+    int32_t userId = GATEWAY_USER_BASE +
+                     static_cast<int32_t>(session.generation * GATEWAY_MAX_SESSIONS + index);
+    session.userId.store(userId, std::memory_order_release);
+    return userId;
+}
+
+void Gateway::run() {
+    std::vector<pollfd> fds;
+    auto lastReap = std::chrono::steady_clock::now();
+    unsigned idleSpins = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        bool busy = false;
+        if (segment != nullptr) {
+            busy = serviceShmSlots();
+        }
+        if (listenFd >= 0) {
+            acceptClients();
+            for (size_t i = GATEWAY_SHM_CLIENTS; i < GATEWAY_MAX_SESSIONS; ++i) {
+                Session& session = sessions[i];
+                if (session.fd >= 0) {
+                    busy |= readSocket(session);
+                }
+                if (session.fd >= 0) {
+                    busy |= flushSocket(session);
+                }
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (segment != nullptr && now - lastReap >= std::chrono::seconds(1)) {
+            reapDeadClients();
+            lastReap = now;
+        }
+
+        if (busy) {
+            idleSpins = 0;
+            continue;
+        }
+        if (++idleSpins < IDLE_SPINS) {
+            cpuRelax();
+            continue;
+        }
+
+        // Idle: sleep until a socket has something or for a millisecond,
+        // which bounds how long a shared memory request can wait
+        fds.clear();
+        if (listenFd >= 0) {
+            fds.push_back(pollfd{listenFd, POLLIN, 0});
+            for (size_t i = GATEWAY_SHM_CLIENTS; i < GATEWAY_MAX_SESSIONS; ++i) {
+                const Session& session = sessions[i];
+                if (session.fd >= 0) {
+                    short events = POLLIN;
+                    if (session.outputOffset < session.output.size()) {
+                        events |= POLLOUT;
+                    }
+                    fds.push_back(pollfd{session.fd, events, 0});
+                }
+            }
+        }
+        ::poll(fds.empty() ? nullptr : fds.data(), fds.size(), 1);
+    }
+}
+
+bool Gateway::serviceShmSlots() {
+    GatewayRequest requests[REQUEST_BATCH];
+    bool busy = false;
+
+    for (size_t i = 0; i < GATEWAY_SHM_CLIENTS; ++i) {
+        GatewaySlot& slot = segment->slots[i];
+        Session& session = sessions[i];
+        GatewaySlotState state = slotState(slot);
+
+        if (state == GatewaySlotState::CLAIMED) {
+            // Anything a crashed client before this one left is not replayed
+            slot.requests.skipAll();
+            slot.responsesDropped.store(0, std::memory_order_relaxed);
+            slot.userId.store(openSession(i), std::memory_order_relaxed);
+            setSlotState(slot, GatewaySlotState::ACTIVE);
+            busy = true;
+            continue;
+        }
+        if (state != GatewaySlotState::ACTIVE && state != GatewaySlotState::CLOSING) {
+            continue;
+        }
+
+        size_t count = slot.requests.tryPopBatch(requests, REQUEST_BATCH);
+        if (count > 0) {
+            submitRequests(requests, count, session, i);
+            busy = true;
+        } else if (state == GatewaySlotState::CLOSING) {
+            session.userId.store(0, std::memory_order_release);
+            slot.pid.store(0, std::memory_order_relaxed);
+            setSlotState(slot, GatewaySlotState::FREE);
+        }
+    }
+    return busy;
+}
+
+// A slot whose process has gone is freed whatever state it was left in
+void Gateway::reapDeadClients() {
+    for (size_t i = 0; i < GATEWAY_SHM_CLIENTS; ++i) {
+        GatewaySlot& slot = segment->slots[i];
+        int32_t pid = slot.pid.load(std::memory_order_relaxed);
+        if (slotState(slot) == GatewaySlotState::FREE || pid <= 0) {
+            continue;
+        }
+        if (kill(pid, 0) != 0 && errno == ESRCH) {
+            sessions[i].userId.store(0, std::memory_order_release);
+            slot.pid.store(0, std::memory_order_relaxed);
+            setSlotState(slot, GatewaySlotState::FREE);
+        }
+    }
+}
+
+bool Gateway::toOrder(const GatewayRequest& request, int32_t userId, Ticks now, Order& order) {
+    if (request.action > static_cast<uint8_t>(OrderAction::MODIFY) ||
+        request.type > static_cast<uint8_t>(OrderType::ICEBERG) ||
+        request.side > static_cast<uint8_t>(Side::SELL) ||
+        request.symbol >= engine.getSymbolCount()) {
+        return false;
+    }
+
+    order = Order{};
+    order.userId = userId;
+    order.symbol = request.symbol;
+    order.action = static_cast<OrderAction>(request.action);
+    order.timestamp = now;
+    order.clientTag = request.clientTag;
+
+    switch (order.action) {
+        case OrderAction::NEW:
+            if (nextOrderId == reservedEnd) {
+                nextOrderId = engine.reserveOrderIds(ORDER_ID_BLOCK);
+                reservedEnd = nextOrderId + ORDER_ID_BLOCK;
+            }
+            order.id = nextOrderId++;
+            order.type = static_cast<OrderType>(request.type);
+            order.side = static_cast<Side>(request.side);
+            order.price = request.price;
+            order.quantity = request.quantity;
+            order.triggerPrice = request.triggerPrice;
+            if (order.type == OrderType::ICEBERG) {
+                order.totalQuantity = request.quantity;
+                order.displayQuantity = request.displayQuantity;
+            }
+            break;
+        case OrderAction::MODIFY:
+            order.price = request.price;
+            order.quantity = request.quantity;
+            [[fallthrough]];
+        default:
+            order.id = request.orderId;
+            break;
+    }
+    return true;
+}
+
+// Values are checked by the shard like any other order, and a MODIFY once
+// more by the book against the order it amends; either rejects them with an
+// ack. A request the engine could not even represent ends the session.
+void Gateway::submitRequests(const GatewayRequest* requests, size_t count, Session& session, size_t index) {
+    int32_t userId = session.userId.load(std::memory_order_relaxed);
+    Ticks now = TscClock::now();
+    size_t converted = 0;
+    bool malformed = false;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!toOrder(requests[i], userId, now, batch[converted])) {
+            malformed = true;
+            break;
+        }
+        ++converted;
+    }
+
+    if (converted > 0) {
+        engine.submitOrders(batch.data(), converted);
+        BENCHMARK_ADD(Counter::GATEWAY_REQUESTS, static_cast<long>(converted));
+    }
+
+    if (malformed) {
+        BENCHMARK_COUNT(Counter::GATEWAY_SESSIONS_REVOKED);
+        if (index < GATEWAY_SHM_CLIENTS) {
+            session.userId.store(0, std::memory_order_release);
+            setSlotState(segment->slots[index], GatewaySlotState::REVOKED);
+        } else {
+            closeSocket(session);
+        }
+    }
+}
+
+void Gateway::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            return;
+        }
+
+        size_t index = GATEWAY_SHM_CLIENTS;
+        while (index < GATEWAY_MAX_SESSIONS && sessions[index].fd >= 0) {
+            ++index;
+        }
+        if (index == GATEWAY_MAX_SESSIONS) {
+            ::close(fd);
+            continue;
+        }
+
+        // The session's first message tells the client who it is
+        Session& session = sessions[index];
+        session.fd = fd;
+        session.input.clear();
+        session.output.clear();
+        session.outputOffset = 0;
+        session.socketResponses->skipAll();
+        session.socketDropped.store(0, std::memory_order_relaxed);
+
+        GatewayResponse hello{};
+        hello.kind = GatewayResponseKind::SESSION;
+        hello.userId = openSession(index);
+        hello.quantity = static_cast<Quantity>(engine.getSymbolCount());
+        const char* bytes = reinterpret_cast<const char*>(&hello);
+        session.output.insert(session.output.end(), bytes, bytes + sizeof(hello));
+        flushSocket(session);
+    }
+}
+
+// A read can end mid-request; the partial request is kept for the next one
+bool Gateway::readSocket(Session& session) {
+    size_t kept = session.input.size();
+    std::memcpy(readBuffer.data(), session.input.data(), kept);
+    ssize_t received = recv(session.fd, readBuffer.data() + kept, SOCKET_READ_BYTES, 0);
+    if (received <= 0) {
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            closeSocket(session);
+        }
+        return false;
+    }
+    size_t available = kept + static_cast<size_t>(received);
+
+    // Requests are copied out of the byte stream, which has no alignment
+    GatewayRequest requests[REQUEST_BATCH];
+    size_t whole = available / sizeof(GatewayRequest);
+    size_t index = static_cast<size_t>(&session - sessions);
+    size_t done = 0;
+    while (done < whole && session.fd >= 0) {
+        size_t count = std::min(whole - done, REQUEST_BATCH);
+        std::memcpy(requests, readBuffer.data() + done * sizeof(GatewayRequest), count * sizeof(GatewayRequest));
+        submitRequests(requests, count, session, index);
+        done += count;
+    }
+    session.input.assign(readBuffer.data() + whole * sizeof(GatewayRequest), readBuffer.data() + available);
+    return true;
+}
+
+// Moves responses the publisher queued for this session into the output
+// buffer and writes as much as the socket takes
+bool Gateway::flushSocket(Session& session) {
+    bool moved = false;
+    int32_t userId = session.userId.load(std::memory_order_relaxed);
+    GatewayResponse responses[REQUEST_BATCH];
+    while (session.output.size() - session.outputOffset < SOCKET_OUTPUT_LIMIT) {
+        size_t count = session.socketResponses->tryPopBatch(responses, REQUEST_BATCH);
+        if (count == 0) {
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            // Left over from the client that had this session before
+            if (responses[i].userId != userId) {
+                continue;
+            }
+            const char* bytes = reinterpret_cast<const char*>(&responses[i]);
+            session.output.insert(session.output.end(), bytes, bytes + sizeof(GatewayResponse));
+        }
+        moved = true;
+    }
+
+    while (session.outputOffset < session.output.size()) {
+        ssize_t sent = ::send(session.fd, session.output.data() + session.outputOffset,
+                              session.output.size() - session.outputOffset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                closeSocket(session);
+            }
+            return moved;
+        }
+        session.outputOffset += static_cast<size_t>(sent);
+        moved = true;
+    }
+    session.output.clear();
+    session.outputOffset = 0;
+    return moved;
+}
+
+void Gateway::closeSocket(Session& session) {
+    session.userId.store(0, std::memory_order_release);
+    ::close(session.fd);
+    session.fd = -1;
+}
+
+void Gateway::respond(int32_t userId, const GatewayResponse& response) {
+    Session& session = sessions[static_cast<size_t>(userId - GATEWAY_USER_BASE) % GATEWAY_MAX_SESSIONS];
+    if (session.userId.load(std::memory_order_acquire) != userId || session.responses == nullptr) {
+        return;
+    }
+    if (!session.responses->tryPush(response)) {
+        session.responsesDropped->fetch_add(1, std::memory_order_relaxed);
+        BENCHMARK_COUNT(Counter::GATEWAY_RESPONSES_DROPPED);
+    }
+}
+
+void Gateway::onResult(const OrderResult& result) {
+    if (result.userId < GATEWAY_USER_BASE) {
+        return;
+    }
+    GatewayResponse response{};
+    response.clientTag = result.clientTag;
+    response.sequence = result.sequence;
+    response.orderId = result.orderId;
+    response.userId = result.userId;
+    response.symbol = result.symbol;
+    response.kind = result.accepted ? GatewayResponseKind::ACCEPTED : GatewayResponseKind::REJECTED;
+    response.action = static_cast<uint8_t>(result.action);
+    respond(result.userId, response);
+}
+
+// A trade is reported to each owner that is a gateway user; the two orders
+// can belong to the same session, which then gets two fills
+void Gateway::onFill(const OrderResult& fill) {
+    GatewayResponse response{};
+    response.clientTag = fill.clientTag;
+    response.sequence = fill.sequence;
+    response.price = fill.price;
+    response.quantity = fill.quantity;
+    response.orderId = fill.orderId;
+    response.userId = fill.userId;
+    response.symbol = fill.symbol;
+    response.kind = GatewayResponseKind::FILL;
+    response.side = static_cast<uint8_t>(fill.side);
+    response.maker = fill.maker ? 1 : 0;
+    respond(fill.userId, response);
+}
@@ -0,0 +1,250 @@
+#include "gateway_client.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t SOCKET_READ_BYTES = 64 * 1024;
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point deadlineAfter(double seconds) {
+    return Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+GatewaySlotState slotState(const GatewaySlot& slot) {
+    return static_cast<GatewaySlotState>(slot.state.load(std::memory_order_acquire));
+}
+
+bool changeSlotState(GatewaySlot& slot, GatewaySlotState from, GatewaySlotState to) {
+    uint32_t expected = static_cast<uint32_t>(from);
+    return slot.state.compare_exchange_strong(expected, static_cast<uint32_t>(to), std::memory_order_acq_rel);
+}
+
+}  // namespace
+
+GatewayClient::~GatewayClient() {
+    disconnect();
+}
+
+bool GatewayClient::connectShm(const std::string& name, std::string& error, double timeoutSeconds) {
+    int shmFd = shm_open(name.c_str(), O_RDWR, 0);
+    if (shmFd < 0) {
+        error = "could not open shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(shmFd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(GatewaySegment)) {
+        error = name + " is not an order entry gateway";
+        ::close(shmFd);
+        return false;
+    }
+    mappedSize = sizeof(GatewaySegment);
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+    ::close(shmFd);
+    if (mapping == MAP_FAILED) {
+        error = "could not map shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    segment = static_cast<GatewaySegment*>(mapping);
+    if (segment->magic != GATEWAY_MAGIC || segment->version != GATEWAY_VERSION ||
+        segment->running.load(std::memory_order_acquire) == 0) {
+        error = name + " is not a running gateway of this version";
+        disconnect();
+        return false;
+    }
+
+    for (uint32_t i = 0; i < segment->slotCount && slot == nullptr; ++i) {
+        if (changeSlotState(segment->slots[i], GatewaySlotState::FREE, GatewaySlotState::CLAIMED)) {
+            slot = &segment->slots[i];
+        }
+    }
+    if (slot == nullptr) {
+        error = "every client slot of " + name + " is taken";
+        disconnect();
+        return false;
+    }
+    slot->pid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+
+    auto deadline = deadlineAfter(timeoutSeconds);
+    while (slotState(*slot) == GatewaySlotState::CLAIMED) {
+        if (Clock::now() >= deadline) {
+            error = "the gateway did not open a session";
+            disconnect();
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // Responses still queued are for whoever had the slot before
+    userId = slot->userId.load(std::memory_order_relaxed);
+    symbolCount = segment->symbolCount;
+    slot->responses.skipAll();
+    connected = true;
+    return true;
+}
+
+bool GatewayClient::connectSocket(const std::string& path, std::string& error, double timeoutSeconds) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        error = "socket path " + path + " is too long";
+        return false;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        error = "could not connect to " + path + ": " + std::strerror(errno);
+        disconnect();
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    readBuffer.resize(sizeof(GatewayResponse) + SOCKET_READ_BYTES);
+
+    // The gateway's first message names the session, or the connection is
+    // closed if it has no room for another client
+    connected = true;
+    auto deadline = deadlineAfter(timeoutSeconds);
+    GatewayResponse hello;
+    while (pollSocket(&hello, 1) == 0) {
+        if (!connected || Clock::now() >= deadline) {
+            error = "the gateway at " + path + " did not open a session";
+            disconnect();
+            return false;
+        }
+        pollfd wait{fd, POLLIN, 0};
+        ::poll(&wait, 1, 10);
+    }
+    if (hello.kind != GatewayResponseKind::SESSION) {
+        error = "unexpected first message from " + path;
+        disconnect();
+        return false;
+    }
+    userId = hello.userId;
+    symbolCount = static_cast<uint32_t>(hello.quantity);
+    return true;
+}
+
+size_t GatewayClient::send(const GatewayRequest* requests, size_t count) {
+    if (!connected) {
+        return 0;
+    }
+    if (slot != nullptr) {
+        return slot->requests.tryPushBatch(requests, count);
+    }
+
+    // A request the socket only took part of is finished before any other
+    if (!flushSocket() || count == 0) {
+        return 0;
+    }
+    ssize_t sent = ::send(fd, requests, count * sizeof(GatewayRequest), MSG_NOSIGNAL);
+    if (sent <= 0) {
+        if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            connected = false;
+        }
+        return 0;
+    }
+    size_t whole = static_cast<size_t>(sent) / sizeof(GatewayRequest);
+    size_t partial = static_cast<size_t>(sent) % sizeof(GatewayRequest);
+    if (partial == 0) {
+        return whole;
+    }
+    const char* rest = reinterpret_cast<const char*>(&requests[whole]) + partial;
+    output.assign(rest, rest + sizeof(GatewayRequest) - partial);
+    return whole + 1;
+}
+
+// True once nothing is left over from an earlier send
+bool GatewayClient::flushSocket() {
+    while (!output.empty()) {
+        ssize_t sent = ::send(fd, output.data(), output.size(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                connected = false;
+            }
+            return false;
+        }
+        output.erase(output.begin(), output.begin() + sent);
+    }
+    return true;
+}
+
+size_t GatewayClient::poll(GatewayResponse* out, size_t maxResponses) {
+    if (segment == nullptr) {
+        return fd >= 0 ? pollSocket(out, maxResponses) : 0;
+    }
+
+    size_t count = slot->responses.tryPopBatch(out, maxResponses);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (out[i].userId == userId) {
+            out[kept++] = out[i];
+        }
+    }
+    if (count == 0 && connected &&
+        (slotState(*slot) != GatewaySlotState::ACTIVE || segment->running.load(std::memory_order_acquire) == 0) &&
+        slot->responses.empty()) {
+        connected = false;
+    }
+    return kept;
+}
+
+size_t GatewayClient::pollSocket(GatewayResponse* out, size_t maxResponses) {
+    flushSocket();
+
+    // Never read more than fits in `out`, so nothing is held back but the
+    // start of a response
+    size_t kept = input.size();
+    size_t room = std::min(maxResponses * sizeof(GatewayResponse) - kept, SOCKET_READ_BYTES);
+    std::memcpy(readBuffer.data(), input.data(), kept);
+    ssize_t received = recv(fd, readBuffer.data() + kept, room, 0);
+    if (received <= 0) {
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            connected = false;
+        }
+        return 0;
+    }
+    size_t available = kept + static_cast<size_t>(received);
+    size_t whole = available / sizeof(GatewayResponse);
+    std::memcpy(out, readBuffer.data(), whole * sizeof(GatewayResponse));
+    input.assign(readBuffer.data() + whole * sizeof(GatewayResponse), readBuffer.data() + available);
+    return whole;
+}
+
+void GatewayClient::disconnect() {
+    if (slot != nullptr) {
+        // A session the gateway has not opened yet, or has revoked, is freed
+        // here; an open one is left for the gateway to drain and free
+        slot->pid.store(0, std::memory_order_relaxed);
+        if (!changeSlotState(*slot, GatewaySlotState::CLAIMED, GatewaySlotState::FREE) &&
+            !changeSlotState(*slot, GatewaySlotState::REVOKED, GatewaySlotState::FREE)) {
+            changeSlotState(*slot, GatewaySlotState::ACTIVE, GatewaySlotState::CLOSING);
+        }
+        slot = nullptr;
+    }
+    if (segment != nullptr) {
+        munmap(segment, mappedSize);
+        segment = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    connected = false;
+}
+
+uint64_t GatewayClient::getResponsesDropped() const {
+    return slot != nullptr ? slot->responsesDropped.load(std::memory_order_relaxed) : 0;
+}
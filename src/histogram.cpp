@@ -0,0 +1,76 @@
+#include "histogram.hpp"
+#include <cmath>
+
+namespace histogram {
+
+uint64_t bucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    size_t row = bucket / SUB_BUCKETS;
+    size_t sub = bucket % SUB_BUCKETS;
+    unsigned shift = static_cast<unsigned>(row - 1);
+    uint64_t lower = static_cast<uint64_t>(SUB_BUCKETS + sub) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+}  // namespace histogram
+
+void HistogramSnapshot::add(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+}
+
+void HistogramSnapshot::subtract(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] -= other.buckets[i];
+    }
+    count -= other.count;
+    sum -= other.sum;
+}
+
+uint64_t HistogramSnapshot::valueAt(double quantile) const {
+    if (count == 0)
+        return 0;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count)));
+    if (target == 0)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= target)
+            return histogram::bucketUpperBound(i);
+    }
+    return max();
+}
+
+uint64_t HistogramSnapshot::min() const {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i] != 0)
+            return histogram::bucketUpperBound(i);
+    }
+    return 0;
+}
+
+uint64_t HistogramSnapshot::max() const {
+    for (size_t i = buckets.size(); i > 0; --i) {
+        if (buckets[i - 1] != 0)
+            return histogram::bucketUpperBound(i - 1);
+    }
+    return 0;
+}
+
+void LatencyHistogram::addTo(HistogramSnapshot& snapshot) const {
+    // Count is read first, so a record racing with this copy can only leave
+    // the buckets holding more than `count`, never less
+    snapshot.count += count.load(std::memory_order_acquire);
+    snapshot.sum += sum.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        snapshot.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+}
@@ -1,79 +1,35 @@
 #include "order_book.hpp"
 #include "logger.hpp"
 #include "benchmark.hpp"
-#include <iostream>
 #include <algorithm>
 
-void OrderBook::addToIcebergBook(const Order& order) {
-    Order visibleOrder = order;
-    visibleOrder.quantity = order.displayQuantity;
-    visibleOrder.type = OrderType::LIMIT;
-    
-    if (order.side == Side::SELL) {
-        asks[order.price].push_back(visibleOrder);
-        icebergAsks[order.price].push_back(order);
-    } else {
-        bids[order.price].push_back(visibleOrder);
-        icebergBids[order.price].push_back(order);
+// A resting ICEBERG slice is a LIMIT node whose displayQuantity is the slice
+// size and whose totalQuantity is everything left of the iceberg, the visible
+// slice included. When the slice fills, the same node is topped up from that
+// reserve and goes to the back of its level, so a refill is a few field
+// writes and one link, whatever else rests at the price.
+bool OrderBook::refillIceberg(NodeIndex index, OrderQueue& level) {
+    Order& slice = pool[index].order;
+    if (slice.displayQuantity <= 0) {
+        return false;
     }
-    
-    Logger::getInstance().logRestingOrder(visibleOrder);
-    Benchmark::getInstance().incrementCounter("Orders_Resting");
-}
 
-void OrderBook::addToIcebergTrackingOnly(const Order& order) {
-    if (order.side == Side::SELL) {
-        icebergAsks[order.price].push_back(order);
-    } else {
-        icebergBids[order.price].push_back(order);
+    if (slice.totalQuantity <= 0) {
+        return false;
     }
-}
 
-void OrderBook::refillIcebergOrder(const Order& fullyExecutedOrder, double tradedQty, const std::function<void(double)>&) {
-    double price = fullyExecutedOrder.price;
-    
-    auto& icebergBook = (fullyExecutedOrder.side == Side::SELL) ? icebergAsks : icebergBids;
-    auto& normalBook = (fullyExecutedOrder.side == Side::SELL) ? asks : bids;
-    
-    auto icebergIt = icebergBook.find(price);
-    if (icebergIt == icebergBook.end() || icebergIt->second.empty()) {
-        return;
-    }
-    
-    auto& icebergQueue = icebergIt->second;
-    
-    for (auto it = icebergQueue.begin(); it != icebergQueue.end(); ++it) {
-        if (it->id == fullyExecutedOrder.id) {
-            it->totalQuantity -= tradedQty;
-            
-            if (it->totalQuantity <= 0) {
-                if (fullyExecutedOrder.userId == 0) {
-                    std::cout << "[ICEBERG COMPLETE] Your ICEBERG order fully executed!\n";
-                }
-                icebergQueue.erase(it);
-                if (icebergQueue.empty()) {
-                    icebergBook.erase(icebergIt);
-                }
-                return;
-            }
-            
-            double newVisibleQty = std::min(it->displayQuantity, it->totalQuantity);
-            if (newVisibleQty > 0) {
-                Order newVisibleOrder = *it;
-                newVisibleOrder.quantity = newVisibleQty;
-                newVisibleOrder.type = OrderType::LIMIT;
-                
-                normalBook[price].push_back(newVisibleOrder);
-                
-                Logger::getInstance().logRestingOrder(newVisibleOrder);
-                Benchmark::getInstance().incrementCounter("Orders_Resting");
-                Benchmark::getInstance().incrementCounter("Iceberg_Orders_Refilled");
-                
-                if (fullyExecutedOrder.userId == 0) {
-                    std::cout << "[ICEBERG REFILL] " << newVisibleQty << " more shares now visible @ $" << price << " (remaining: " << it->totalQuantity << ")\n";
-                }
-            }
-            return;
-        }
+    slice.quantity = std::min(slice.displayQuantity, slice.totalQuantity);
+    level.pushBack(pool, index);
+
+    Logger::getInstance().logRestingOrder(slice, instrument);
+    BENCHMARK_COUNT(Counter::ORDERS_RESTING);
+    BENCHMARK_COUNT(Counter::ICEBERG_ORDERS_REFILLED);
+
+    if (wantsReport(slice.userId)) {
+        ExecutionReport report = makeExecutionReport(ExecutionKind::REFILLED, slice);
+        report.type = OrderType::ICEBERG;
+        report.remaining = slice.totalQuantity;
+        pushReport(report);
     }
+    return true;
 }
@@ -0,0 +1,232 @@
+#include "journal.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t JOURNAL_MAGIC = 0x314C4E524A424F00;  // "\0OBJRNL1"
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+struct JournalHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t layoutHash;
+    uint8_t reserved[40];
+};
+
+static_assert(sizeof(JournalHeader) == 64, "journal header must stay 64 bytes");
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+}  // namespace
+
+Journal::Journal(const JournalConfig& config_, uint64_t layoutHash_)
+    : config(config_), layoutHash(layoutHash_) {}
+
+Journal::~Journal() {
+    close();
+}
+
+size_t Journal::dataOffset() {
+    return sizeof(JournalHeader);
+}
+
+bool Journal::open(std::string& error) {
+    std::filesystem::path path(config.path);
+    if (path.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    fd = ::open(config.path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        error = "could not open " + config.path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        error = "could not stat " + config.path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    bool fresh = st.st_size == 0;
+    size_t size = std::max(static_cast<size_t>(st.st_size), config.growBytes);
+    if (!mapFile(size, error)) {
+        return false;
+    }
+
+    JournalHeader* header = reinterpret_cast<JournalHeader*>(base);
+    if (fresh) {
+        header->magic = JOURNAL_MAGIC;
+        header->version = JOURNAL_VERSION;
+        header->recordSize = sizeof(JournalRecord);
+        header->layoutHash = layoutHash;
+    } else if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION ||
+               header->recordSize != sizeof(JournalRecord)) {
+        error = config.path + " is not a journal written by this version";
+        return false;
+    } else if (header->layoutHash != layoutHash) {
+        error = config.path + " was written for a different set of symbols";
+        return false;
+    }
+
+    // Find the end: the first record that was never (completely) written
+    writeOffset = dataOffset();
+    while (writeOffset + sizeof(JournalRecord) <= mappedSize) {
+        const JournalRecord& record = *reinterpret_cast<const JournalRecord*>(base + writeOffset);
+        if (record.sequence == 0 || record.checksum != checksumOf(record)) {
+            break;
+        }
+        lastSequence = record.sequence;
+        maxOrderId = std::max(maxOrderId, record.orderId);
+        writeOffset += sizeof(JournalRecord);
+    }
+
+    // Clear a torn tail so it can't be mistaken for data after new appends
+    if (writeOffset + sizeof(JournalRecord) <= mappedSize) {
+        std::memset(base + writeOffset, 0, sizeof(JournalRecord));
+    }
+
+    syncedOffset = writeOffset;
+    lastSync = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool Journal::mapFile(size_t size, std::string& error) {
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        error = "could not extend " + config.path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        error = "could not map " + config.path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    base = static_cast<char*>(mapping);
+    mappedSize = size;
+    return true;
+}
+
+void Journal::append(const Order& order) {
+    if (writeOffset + sizeof(JournalRecord) > mappedSize) {
+        // Dirty pages belong to the file, so unmapping loses nothing
+        munmap(base, mappedSize);
+        base = nullptr;
+        std::string error;
+        if (!mapFile(mappedSize + config.growBytes, error)) {
+            // Carrying on would match orders that can never be replayed
+            std::cerr << "Fatal: journal " << error << "\n";
+            std::abort();
+        }
+    }
+
+    // Zeroed as a whole so padding bytes are deterministic for the checksum
+    JournalRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.sequence = order.sequence;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.triggerPrice = order.triggerPrice;
+    record.totalQuantity = order.totalQuantity;
+    record.displayQuantity = order.displayQuantity;
+    record.orderId = order.id;
+    record.userId = order.userId;
+    record.symbol = order.symbol;
+    record.action = static_cast<uint8_t>(order.action);
+    record.type = static_cast<uint8_t>(order.type);
+    record.side = static_cast<uint8_t>(order.side);
+    record.checksum = checksumOf(record);
+    std::memcpy(base + writeOffset, &record, sizeof(record));
+
+    writeOffset += sizeof(JournalRecord);
+    lastSequence = order.sequence;
+    maxOrderId = std::max(maxOrderId, order.id);
+}
+
+void Journal::commit() {
+    switch (config.sync) {
+        case JournalSync::NONE:
+            break;
+        case JournalSync::PERIODIC: {
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastSync >= std::chrono::milliseconds(config.syncIntervalMs)) {
+                sync();
+                lastSync = now;
+            }
+            break;
+        }
+        case JournalSync::PER_BATCH:
+            sync();
+            break;
+    }
+}
+
+void Journal::sync() {
+    if (base == nullptr || syncedOffset == writeOffset) {
+        return;
+    }
+    size_t start = syncedOffset & ~(pageSize() - 1);
+    msync(base + start, writeOffset - start, MS_SYNC);
+    syncedOffset = writeOffset;
+}
+
+void Journal::close() {
+    if (base != nullptr) {
+        if (config.sync != JournalSync::NONE) {
+            sync();
+        }
+        munmap(base, mappedSize);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+size_t Journal::getRecordCount() const {
+    return (writeOffset - dataOffset()) / sizeof(JournalRecord);
+}
+
+Order Journal::toOrder(const JournalRecord& record) {
+    Order order{};
+    order.id = record.orderId;
+    order.userId = record.userId;
+    order.type = static_cast<OrderType>(record.type);
+    order.side = static_cast<Side>(record.side);
+    order.price = record.price;
+    order.quantity = record.quantity;
+    order.triggerPrice = record.triggerPrice;
+    order.totalQuantity = record.totalQuantity;
+    order.displayQuantity = record.displayQuantity;
+    order.timestamp = TscClock::now();
+    order.action = static_cast<OrderAction>(record.action);
+    order.symbol = record.symbol;
+    order.sequence = record.sequence;
+    return order;
+}
+
+// FNV-1a over the record up to the checksum field
+uint32_t Journal::checksumOf(const JournalRecord& record) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
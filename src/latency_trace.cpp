@@ -0,0 +1,61 @@
+#include "latency_trace.hpp"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const char* actionName(OrderAction action) {
+    switch (action) {
+        case OrderAction::NEW: return "NEW";
+        case OrderAction::CANCEL: return "CANCEL";
+        case OrderAction::MODIFY: return "MODIFY";
+        case OrderAction::SNAPSHOT: return "SNAPSHOT";
+    }
+    return "UNKNOWN";
+}
+
+double toMicros(Ticks ticks) {
+    return TscClock::toNanos(ticks) / 1000.0;
+}
+
+}
+
+LatencyTrace::LatencyTrace(const TraceConfig& config_) : config(config_) {
+    std::filesystem::path path(config.path);
+    if (path.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    file.open(config.path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Warning: Could not open latency trace " << config.path << "\n";
+        return;
+    }
+    file << "Sequence,OrderId,Symbol,Action,Accepted,"
+            "SubmitToDispatch(us),DispatchToPickup(us),Processing(us),MatchToPublish(us),Total(us)\n";
+}
+
+void LatencyTrace::write(const OrderResult& result, Ticks published) {
+    const OrderStages& stages = result.stages;
+    Ticks total = TscClock::elapsed(result.submitted, published);
+
+    file << result.sequence << ","
+         << result.orderId << ","
+         << result.symbol << ","
+         << actionName(result.action) << ","
+         << (result.accepted ? 1 : 0) << ","
+         << std::fixed << std::setprecision(3)
+         << toMicros(stages.dispatched) << ","
+         << toMicros(TscClock::elapsed(stages.dispatched, stages.pickedUp)) << ","
+         << toMicros(TscClock::elapsed(stages.pickedUp, stages.matched)) << ","
+         << toMicros(TscClock::elapsed(stages.matched, total)) << ","
+         << toMicros(total) << "\n";
+}
+
+void LatencyTrace::flush() {
+    if (file.is_open()) {
+        file.flush();
+    }
+}
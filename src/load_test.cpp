@@ -0,0 +1,170 @@
+#include "load_test.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+// Stages reported in the summary, in pipeline order
+const Timing REPORTED_TIMINGS[] = {
+    Timing::ORDER_SUBMISSION,
+    Timing::SUBMIT_TO_DISPATCH,
+    Timing::DISPATCH_TO_PICKUP,
+    Timing::ORDER_PROCESSING,
+    Timing::MATCH_TO_PUBLISH,
+    Timing::SUBMIT_TO_PUBLISH,
+};
+
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+const char* const QUANTILE_LABELS[] = {"p50", "p90", "p99", "p99_9"};
+
+double toMicros(uint64_t ticks) {
+    return TscClock::toNanos(ticks) / 1000.0;
+}
+
+double perSecond(double count, double seconds) {
+    return seconds > 0 ? count / seconds : 0.0;
+}
+
+}
+
+LoadTest::LoadTest(Engine& engine_, BackgroundGenerator& generator_, const LoadTestConfig& config_)
+    : engine(engine_), generator(generator_), config(config_) {
+}
+
+LoadTestReport LoadTest::run() {
+    using Clock = std::chrono::steady_clock;
+
+    LoadTestReport report;
+    Benchmark& benchmark = Benchmark::getInstance();
+    benchmark.reset();
+
+    auto start = Clock::now();
+    auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config.durationSeconds));
+    auto interval = std::chrono::milliseconds(std::max(1u, config.sampleIntervalMs));
+
+    generator.start();
+
+    size_t samples = 0;
+    double depthSum = 0.0;
+    for (auto next = start + interval; next < end; next += interval) {
+        std::this_thread::sleep_until(next);
+        size_t depth = engine.getQueueDepth();
+        report.maxQueueDepth = std::max(report.maxQueueDepth, depth);
+        depthSum += static_cast<double>(depth);
+        ++samples;
+    }
+    std::this_thread::sleep_until(end);
+
+    generator.stop();
+    auto stopped = Clock::now();
+    report.elapsedSeconds = std::chrono::duration<double>(stopped - start).count();
+    report.meanQueueDepth = samples > 0 ? depthSum / samples : 0.0;
+
+    // Everything already submitted still counts: stopping the engine drains
+    // every stage, so the latencies include the backlog
+    engine.stop();
+    report.drainSeconds = std::chrono::duration<double>(Clock::now() - stopped).count();
+
+    report.ordersSubmitted = benchmark.getCounter(Counter::ORDERS_SUBMITTED);
+    report.requestsPublished = static_cast<uint64_t>(benchmark.getCounter(Counter::RESULTS_PUBLISHED));
+    for (Timing timing : REPORTED_TIMINGS) {
+        report.latencies.emplace_back(timing, benchmark.getTiming(timing));
+    }
+    return report;
+}
+
+void LoadTest::print(const LoadTestReport& report) const {
+    const GeneratorConfig& generatorConfig = generator.getConfig();
+    double total = report.elapsedSeconds + report.drainSeconds;
+
+    std::cout << "\n=== LOAD TEST SUMMARY ===\n"
+              << "Producers: " << generatorConfig.producers
+              << ", matching threads: " << engine.getShardCount()
+              << ", target rate: ";
+    if (generatorConfig.ratePerSecond > 0) {
+        std::cout << std::fixed << std::setprecision(0) << generatorConfig.ratePerSecond << " orders/sec\n";
+    } else {
+        std::cout << "unlimited\n";
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Duration: " << report.elapsedSeconds << "s (+" << report.drainSeconds << "s drain)\n"
+              << std::setprecision(1)
+              << "Submitted: " << report.ordersSubmitted << " ("
+              << perSecond(report.ordersSubmitted, report.elapsedSeconds) << "/sec)\n"
+              << "Published: " << report.requestsPublished << " ("
+              << perSecond(static_cast<double>(report.requestsPublished), total) << "/sec sustained)\n"
+              << "Queue depth: mean " << report.meanQueueDepth << ", max " << report.maxQueueDepth << "\n\n";
+
+    std::cout << std::left << std::setw(24) << "Latency (us)" << std::right << std::setw(12) << "Count"
+              << std::setw(12) << "Avg";
+    for (const char* label : QUANTILE_LABELS) {
+        std::cout << std::setw(12) << label;
+    }
+    std::cout << std::setw(12) << "max" << "\n";
+
+    std::cout << std::setprecision(3);
+    for (const auto& [timing, latency] : report.latencies) {
+        std::cout << std::left << std::setw(24) << Benchmark::getTimingName(timing) << std::right
+                  << std::setw(12) << latency.count
+                  << std::setw(12) << toMicros(static_cast<uint64_t>(latency.mean()));
+        for (double quantile : QUANTILES) {
+            std::cout << std::setw(12) << toMicros(latency.valueAt(quantile));
+        }
+        std::cout << std::setw(12) << toMicros(latency.max()) << "\n";
+    }
+    std::cout << "=========================\n";
+}
+
+bool LoadTest::writeJson(const LoadTestReport& report) const {
+    if (config.reportPath.empty()) {
+        return true;
+    }
+
+    std::filesystem::path path(config.reportPath);
+    if (path.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+    }
+
+    std::ofstream file(config.reportPath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Warning: Could not write load test report " << config.reportPath << "\n";
+        return false;
+    }
+
+    const GeneratorConfig& generatorConfig = generator.getConfig();
+    double total = report.elapsedSeconds + report.drainSeconds;
+
+    file << std::fixed << std::setprecision(3)
+         << "{\n"
+         << "  \"producers\": " << generatorConfig.producers << ",\n"
+         << "  \"matching_threads\": " << engine.getShardCount() << ",\n"
+         << "  \"symbols\": " << engine.getSymbolCount() << ",\n"
+         << "  \"target_rate\": " << generatorConfig.ratePerSecond << ",\n"
+         << "  \"duration_sec\": " << report.elapsedSeconds << ",\n"
+         << "  \"drain_sec\": " << report.drainSeconds << ",\n"
+         << "  \"orders_submitted\": " << report.ordersSubmitted << ",\n"
+         << "  \"requests_published\": " << report.requestsPublished << ",\n"
+         << "  \"submit_rate\": " << perSecond(report.ordersSubmitted, report.elapsedSeconds) << ",\n"
+         << "  \"sustained_rate\": " << perSecond(static_cast<double>(report.requestsPublished), total) << ",\n"
+         << "  \"queue_depth_mean\": " << report.meanQueueDepth << ",\n"
+         << "  \"queue_depth_max\": " << report.maxQueueDepth << ",\n"
+         << "  \"latency_us\": {\n";
+    for (size_t i = 0; i < report.latencies.size(); ++i) {
+        const auto& [timing, latency] = report.latencies[i];
+        file << "    \"" << Benchmark::getTimingName(timing) << "\": {\"count\": " << latency.count
+             << ", \"avg\": " << toMicros(static_cast<uint64_t>(latency.mean()));
+        for (size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++q) {
+            file << ", \"" << QUANTILE_LABELS[q] << "\": " << toMicros(latency.valueAt(QUANTILES[q]));
+        }
+        file << ", \"max\": " << toMicros(latency.max()) << "}"
+             << (i + 1 < report.latencies.size() ? "," : "") << "\n";
+    }
+    file << "  }\n}\n";
+    return true;
+}
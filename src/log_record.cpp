@@ -0,0 +1,154 @@
+#include "log_record.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+const char* const ORDERS_CSV_HEADER =
+    "Timestamp,OrderID,UserID,Type,Side,Price,Quantity,TriggerPrice,TotalQuantity,DisplayQuantity,Status\n";
+const char* const MATCHES_CSV_HEADER =
+    "Timestamp,IncomingOrderID,RestingOrderID,MatchPrice,MatchQuantity,IncomingSide,RestingSide\n";
+
+int64_t logClockNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+LogRecord makeOrderRecord(const Order& order, LogStatus status) {
+    LogRecord record{};
+    record.kind = LogRecordKind::ORDER;
+    record.status = status;
+    record.orderType = static_cast<uint8_t>(order.type);
+    record.side = static_cast<uint8_t>(order.side);
+    record.symbol = order.symbol;
+    record.timestampNs = logClockNow();
+    record.orderId = order.id;
+    record.otherId = order.userId;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.triggerPrice = order.triggerPrice;
+    record.totalQuantity = order.totalQuantity;
+    record.displayQuantity = order.displayQuantity;
+    return record;
+}
+
+LogRecord makeMatchRecord(const Order& incomingOrder, const Order& restingOrder, Price matchPrice, Quantity matchQuantity) {
+    LogRecord record{};
+    record.kind = LogRecordKind::MATCH;
+    record.side = static_cast<uint8_t>(incomingOrder.side);
+    record.restingSide = static_cast<uint8_t>(restingOrder.side);
+    record.symbol = incomingOrder.symbol;
+    record.timestampNs = logClockNow();
+    record.orderId = incomingOrder.id;
+    record.otherId = restingOrder.id;
+    record.price = matchPrice;
+    record.quantity = matchQuantity;
+    return record;
+}
+
+LogSegmentRecord makeSegmentRecord(uint16_t instrumentCount) {
+    LogSegmentRecord record{};
+    record.kind = LogRecordKind::SEGMENT;
+    record.version = LOG_FORMAT_VERSION;
+    record.instrumentCount = instrumentCount;
+    record.magic = LOG_SEGMENT_MAGIC;
+    record.startNs = logClockNow();
+    return record;
+}
+
+LogInstrumentRecord makeInstrumentRecord(SymbolId symbol, const Instrument& instrument) {
+    LogInstrumentRecord record{};
+    record.kind = LogRecordKind::INSTRUMENT;
+    record.symbol = symbol;
+    record.tickSize = instrument.tickSize;
+    record.lotSize = instrument.lotSize;
+    record.nameLength = static_cast<uint32_t>(std::min(instrument.symbol.size(), sizeof(record.name)));
+    std::memcpy(record.name, instrument.symbol.data(), record.nameLength);
+    return record;
+}
+
+Instrument instrumentFromRecord(const LogInstrumentRecord& record) {
+    Instrument instrument;
+    instrument.symbol.assign(record.name, std::min<size_t>(record.nameLength, sizeof(record.name)));
+    instrument.tickSize = record.tickSize;
+    instrument.lotSize = record.lotSize;
+    return instrument;
+}
+
+std::string formatLogTimestamp(int64_t timestampNs) {
+    std::time_t seconds = static_cast<std::time_t>(timestampNs / 1000000000);
+    int64_t ms = (timestampNs / 1000000) % 1000;
+
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&seconds), "%Y-%m-%d %H:%M:%S");
+    ss << '.' << std::setfill('0') << std::setw(3) << ms;
+    return ss.str();
+}
+
+namespace {
+
+const char* orderTypeName(uint8_t type) {
+    switch (static_cast<OrderType>(type)) {
+        case OrderType::LIMIT: return "LIMIT";
+        case OrderType::MARKET: return "MARKET";
+        case OrderType::STOP_LIMIT: return "STOP_LIMIT";
+        case OrderType::STOP_MARKET: return "STOP_MARKET";
+        case OrderType::ICEBERG: return "ICEBERG";
+    }
+    return "UNKNOWN";
+}
+
+const char* statusName(LogStatus status) {
+    switch (status) {
+        case LogStatus::SUBMITTED: return "SUBMITTED";
+        case LogStatus::RESTING: return "RESTING";
+        case LogStatus::CANCELLED: return "CANCELLED";
+        case LogStatus::MODIFIED: return "MODIFIED";
+    }
+    return "UNKNOWN";
+}
+
+const char* sideName(uint8_t side) {
+    return static_cast<Side>(side) == Side::BUY ? "BUY" : "SELL";
+}
+
+}  // namespace
+
+void writeOrderCsv(std::ostream& os, const LogRecord& record, const Instrument& instrument) {
+    OrderType type = static_cast<OrderType>(record.orderType);
+
+    os << formatLogTimestamp(record.timestampNs) << ","
+       << record.orderId << ","
+       << record.otherId << ","
+       << orderTypeName(record.orderType) << ","
+       << sideName(record.side) << ","
+       << std::fixed << std::setprecision(2) << instrument.toPrice(record.price) << ","
+       << std::fixed << std::setprecision(2) << instrument.toQuantity(record.quantity) << ",";
+
+    if (type == OrderType::STOP_LIMIT || type == OrderType::STOP_MARKET) {
+        os << std::fixed << std::setprecision(2) << instrument.toPrice(record.triggerPrice) << ",";
+    } else {
+        os << "0.00,";
+    }
+
+    if (type == OrderType::ICEBERG) {
+        os << std::fixed << std::setprecision(2) << instrument.toQuantity(record.totalQuantity) << ","
+           << std::fixed << std::setprecision(2) << instrument.toQuantity(record.displayQuantity) << ",";
+    } else {
+        os << "0.00,0.00,";
+    }
+
+    os << statusName(record.status) << "\n";
+}
+
+void writeMatchCsv(std::ostream& os, const LogRecord& record, const Instrument& instrument) {
+    os << formatLogTimestamp(record.timestampNs) << ","
+       << record.orderId << ","
+       << record.otherId << ","
+       << std::fixed << std::setprecision(2) << instrument.toPrice(record.price) << ","
+       << std::fixed << std::setprecision(2) << instrument.toQuantity(record.quantity) << ","
+       << sideName(record.side) << ","
+       << sideName(record.restingSide) << "\n";
+}
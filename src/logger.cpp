@@ -1,6 +1,13 @@
 #include "logger.hpp"
+#include "spin_wait.hpp"
 #include <iostream>
 #include <filesystem>
+#include <chrono>
+
+namespace {
+constexpr size_t THREAD_RING_CAPACITY = 1 << 16;
+constexpr size_t WRITER_BATCH_SIZE = 4096;
+}
 
 Logger& Logger::getInstance() {
     static Logger instance;
@@ -9,7 +16,28 @@ Logger& Logger::getInstance() {
 
 Logger::Logger() {
     ensureLogsDirectory();
-    
+}
+
+Logger::~Logger() {
+    shutdown();
+
+    if (ordersFile.is_open()) {
+        ordersFile.close();
+    }
+    if (matchesFile.is_open()) {
+        matchesFile.close();
+    }
+}
+
+void Logger::ensureLogsDirectory() {
+    try {
+        std::filesystem::create_directories("logs");
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Could not create logs directory: " << e.what() << "\n";
+    }
+}
+
+void Logger::openTextFiles() {
     ordersFile.open("logs/orders.log", std::ios::app);
     matchesFile.open("logs/matches.log", std::ios::app);
     
@@ -23,134 +51,150 @@ Logger::Logger() {
 
     ordersFile.seekp(0, std::ios::end);
     if (ordersFile.tellp() == 0) {
-        ordersFile << "Timestamp,OrderID,UserID,Type,Side,Price,Quantity,TriggerPrice,TotalQuantity,DisplayQuantity,Status\n";
+        ordersFile << ORDERS_CSV_HEADER;
     }
     
     matchesFile.seekp(0, std::ios::end);
     if (matchesFile.tellp() == 0) {
-        matchesFile << "Timestamp,IncomingOrderID,RestingOrderID,MatchPrice,MatchQuantity,IncomingSide,RestingSide\n";
+        matchesFile << MATCHES_CSV_HEADER;
     }
 }
 
-Logger::~Logger() {
-    if (ordersFile.is_open()) {
-        ordersFile.close();
+void Logger::startBinary(const std::vector<Instrument>& instruments, const std::string& path) {
+    binaryFile.open(path, std::ios::binary | std::ios::app);
+    if (!binaryFile.is_open()) {
+        std::cerr << "Warning: Could not open " << path << ", falling back to text logs\n";
+        return;
     }
-    if (matchesFile.is_open()) {
-        matchesFile.close();
+
+    // Every run starts a new segment describing its instruments, so one file
+    // can hold several runs
+    LogSegmentRecord segment = makeSegmentRecord(static_cast<uint16_t>(instruments.size()));
+    binaryFile.write(reinterpret_cast<const char*>(&segment), sizeof(segment));
+    for (size_t i = 0; i < instruments.size(); ++i) {
+        LogInstrumentRecord record = makeInstrumentRecord(static_cast<SymbolId>(i), instruments[i]);
+        binaryFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
     }
+
+    format = LogFormat::BINARY;
+    writerRunning = true;
+    writerThread = std::thread(&Logger::writerLoop, this);
 }
 
-void Logger::ensureLogsDirectory() {
-    try {
-        std::filesystem::create_directories("logs");
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Could not create logs directory: " << e.what() << "\n";
+void Logger::shutdown() {
+    writerRunning = false;
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    if (binaryFile.is_open()) {
+        binaryFile.flush();
     }
 }
 
-std::string Logger::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+void Logger::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
 }
 
-void Logger::logOrder(const Order& order) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    
-    if (ordersFile.is_open()) {
-        std::string orderTypeStr;
-        switch(order.type) {
-            case OrderType::LIMIT: orderTypeStr = "LIMIT"; break;
-            case OrderType::MARKET: orderTypeStr = "MARKET"; break;
-            case OrderType::STOP_LIMIT: orderTypeStr = "STOP_LIMIT"; break;
-            case OrderType::STOP_MARKET: orderTypeStr = "STOP_MARKET"; break;
-            case OrderType::ICEBERG: orderTypeStr = "ICEBERG"; break;
-        }
-        
-        ordersFile << getCurrentTimestamp() << ","
-                  << order.id << ","
-                  << order.userId << ","
-                  << orderTypeStr << ","
-                  << (order.side == Side::BUY ? "BUY" : "SELL") << ","
-                  << std::fixed << std::setprecision(2) << order.price << ","
-                  << std::fixed << std::setprecision(2) << order.quantity << ",";
-        
-        if (order.type == OrderType::STOP_LIMIT || order.type == OrderType::STOP_MARKET) {
-            ordersFile << std::fixed << std::setprecision(2) << order.triggerPrice << ",";
-        } else {
-            ordersFile << "0.00,";
+void Logger::append(const LogRecord& record, const Instrument& instrument) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (format == LogFormat::BINARY) {
+        SpscRing<LogRecord>& ring = threadRing();
+        // Never drop a record: a full ring waits for the writer
+        for (unsigned spins = 0; !ring.tryPush(record); ++spins) {
+            if (spins < 64) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
         }
-        
-        if (order.type == OrderType::ICEBERG) {
-            ordersFile << std::fixed << std::setprecision(2) << order.totalQuantity << ","
-                      << std::fixed << std::setprecision(2) << order.displayQuantity << ",";
+        return;
+    }
+
+    std::call_once(textFilesOpened, &Logger::openTextFiles, this);
+    std::lock_guard<std::mutex> lock(logMutex);
+
+    std::ofstream& file = (record.kind == LogRecordKind::MATCH) ? matchesFile : ordersFile;
+    if (file.is_open()) {
+        if (record.kind == LogRecordKind::MATCH) {
+            writeMatchCsv(file, record, instrument);
         } else {
-            ordersFile << "0.00,0.00,";
+            writeOrderCsv(file, record, instrument);
         }
-        
-        ordersFile << "SUBMITTED" << "\n";
-        ordersFile.flush();
+        file.flush();
     }
 }
 
-void Logger::logMatch(const Order& incomingOrder, const Order& restingOrder, 
-                     double matchPrice, double matchQuantity) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    
-    if (matchesFile.is_open()) {
-        matchesFile << getCurrentTimestamp() << ","
-                   << incomingOrder.id << ","
-                   << restingOrder.id << ","
-                   << std::fixed << std::setprecision(2) << matchPrice << ","
-                   << std::fixed << std::setprecision(2) << matchQuantity << ","
-                   << (incomingOrder.side == Side::BUY ? "BUY" : "SELL") << ","
-                   << (restingOrder.side == Side::BUY ? "BUY" : "SELL") << "\n";
-        matchesFile.flush();
+SpscRing<LogRecord>& Logger::threadRing() {
+    thread_local SpscRing<LogRecord>* ring = nullptr;
+    if (ring == nullptr) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.push_back(std::make_unique<SpscRing<LogRecord>>(THREAD_RING_CAPACITY));
+        ring = rings.back().get();
+        ringCount.store(rings.size(), std::memory_order_release);
     }
+    return *ring;
 }
 
-void Logger::logRestingOrder(const Order& order) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    
-    if (ordersFile.is_open()) {
-        std::string orderTypeStr;
-        switch(order.type) {
-            case OrderType::LIMIT: orderTypeStr = "LIMIT"; break;
-            case OrderType::MARKET: orderTypeStr = "MARKET"; break;
-            case OrderType::STOP_LIMIT: orderTypeStr = "STOP_LIMIT"; break;
-            case OrderType::STOP_MARKET: orderTypeStr = "STOP_MARKET"; break;
-            case OrderType::ICEBERG: orderTypeStr = "ICEBERG"; break;
+size_t Logger::drainRings(std::vector<SpscRing<LogRecord>*>& active, std::vector<LogRecord>& batch) {
+    if (active.size() != ringCount.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        active.clear();
+        for (auto& ring : rings) {
+            active.push_back(ring.get());
         }
-        
-        ordersFile << getCurrentTimestamp() << ","
-                  << order.id << ","
-                  << order.userId << ","
-                  << orderTypeStr << ","
-                  << (order.side == Side::BUY ? "BUY" : "SELL") << ","
-                  << std::fixed << std::setprecision(2) << order.price << ","
-                  << std::fixed << std::setprecision(2) << order.quantity << ",";
-        
-        if (order.type == OrderType::STOP_LIMIT || order.type == OrderType::STOP_MARKET) {
-            ordersFile << std::fixed << std::setprecision(2) << order.triggerPrice << ",";
-        } else {
-            ordersFile << "0.00,";
+    }
+
+    size_t written = 0;
+    for (SpscRing<LogRecord>* ring : active) {
+        size_t count;
+        while ((count = ring->tryPopBatch(batch.data(), batch.size())) > 0) {
+            binaryFile.write(reinterpret_cast<const char*>(batch.data()), count * sizeof(LogRecord));
+            written += count;
         }
-        
-        if (order.type == OrderType::ICEBERG) {
-            ordersFile << std::fixed << std::setprecision(2) << order.totalQuantity << ","
-                      << std::fixed << std::setprecision(2) << order.displayQuantity << ",";
-        } else {
-            ordersFile << "0.00,0.00,";
+    }
+    return written;
+}
+
+void Logger::writerLoop() {
+    std::vector<SpscRing<LogRecord>*> active;
+    std::vector<LogRecord> batch(WRITER_BATCH_SIZE);
+
+    while (true) {
+        // Read the flag before draining: an empty pass after shutdown() was
+        // requested means nothing is left to write
+        bool stopping = !writerRunning.load();
+        if (drainRings(active, batch) > 0) {
+            continue;
+        }
+
+        binaryFile.flush();
+        if (stopping) {
+            break;
         }
-        
-        ordersFile << "RESTING" << "\n";
-        ordersFile.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
+
+void Logger::logOrder(const Order& order, const Instrument& instrument) {
+    append(makeOrderRecord(order, LogStatus::SUBMITTED), instrument);
+}
+
+void Logger::logRestingOrder(const Order& order, const Instrument& instrument) {
+    append(makeOrderRecord(order, LogStatus::RESTING), instrument);
+}
+
+void Logger::logCancelledOrder(const Order& order, const Instrument& instrument) {
+    append(makeOrderRecord(order, LogStatus::CANCELLED), instrument);
+}
+
+void Logger::logModifiedOrder(const Order& order, const Instrument& instrument) {
+    append(makeOrderRecord(order, LogStatus::MODIFIED), instrument);
+}
+
+void Logger::logMatch(const Order& incomingOrder, const Order& restingOrder, 
+                     Price matchPrice, Quantity matchQuantity, const Instrument& instrument) {
+    append(makeMatchRecord(incomingOrder, restingOrder, matchPrice, matchQuantity), instrument);
+}
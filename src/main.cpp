@@ -1,27 +1,360 @@
 #include <iostream>
 #include <thread>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <type_traits>
 
 #include "background_generator.hpp"
+#include "load_test.hpp"
 #include "engine.hpp"
 #include "ui.hpp"
 #include "benchmark.hpp"
+#include "logger.hpp"
 
-int main() {
+namespace {
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Largest ring the pipeline and the market data feed accept; rounding a
+// larger size up to a power of two could overflow
+constexpr size_t MAX_RING_CAPACITY = size_t{1} << 30;
+
+// The whole of `text` as a T. Throws std::invalid_argument or
+// std::out_of_range like the std::sto* functions it wraps; unsigned values
+// refuse a sign rather than wrap it.
+template <typename T>
+T parseNumber(const std::string& text) {
+    size_t used = 0;
+    T value;
+    if constexpr (std::is_floating_point_v<T>) {
+        value = static_cast<T>(std::stod(text, &used));
+    } else if constexpr (std::is_signed_v<T>) {
+        long long parsed = std::stoll(text, &used);
+        if (parsed < std::numeric_limits<T>::min() || parsed > std::numeric_limits<T>::max()) {
+            throw std::out_of_range(text);
+        }
+        value = static_cast<T>(parsed);
+    } else {
+        if (text.find('-') != std::string::npos) {
+            throw std::invalid_argument(text);
+        }
+        unsigned long long parsed = std::stoull(text, &used);
+        if (parsed > std::numeric_limits<T>::max()) {
+            throw std::out_of_range(text);
+        }
+        value = static_cast<T>(parsed);
+    }
+    if (used != text.size()) {
+        throw std::invalid_argument(text);
+    }
+    return value;
+}
+
+// Parses the value of a numeric flag into `value` if it is a number in
+// [min, max]; otherwise says what was expected and leaves `value` alone
+template <typename T>
+bool parseFlag(const std::string& flag, const std::string& text, T min, T max, T& value) {
+    try {
+        T parsed = parseNumber<T>(text);
+        if (parsed >= min && parsed <= max) {
+            value = parsed;
+            return true;
+        }
+    } catch (const std::logic_error&) {
+        // Not a number, or not one T can hold
+    }
+    std::cerr << "Invalid value '" << text << "' for " << flag << ", expected a number ";
+    if (max == std::numeric_limits<T>::max()) {
+        std::cerr << ">= " << min << "\n";
+    } else {
+        std::cerr << "from " << min << " to " << max << "\n";
+    }
+    return false;
+}
+
+// One --symbols entry, NAME[:TICK[:LOT]]; tick and lot sizes left out keep
+// the Instrument defaults
+bool parseInstrument(const std::string& spec, Instrument& instrument) {
+    std::vector<std::string> fields;
+    std::stringstream ss(spec);
+    std::string field;
+    while (std::getline(ss, field, ':')) {
+        fields.push_back(field);
+    }
+    if (fields.empty() || fields.size() > 3 || fields[0].empty()) {
+        std::cerr << "Invalid symbol '" << spec << "', expected NAME[:TICK[:LOT]]\n";
+        return false;
+    }
+
+    const double smallest = 1e-9;
+    const double largest = std::numeric_limits<double>::max();
+    instrument.symbol = fields[0];
+    if (fields.size() > 1 && !parseFlag("--symbols tick size", fields[1], smallest, largest, instrument.tickSize)) {
+        return false;
+    }
+    if (fields.size() > 2 && !parseFlag("--symbols lot size", fields[2], smallest, largest, instrument.lotSize)) {
+        return false;
+    }
+    return true;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --book-backend map|ladder   Price level storage (default from build)\n"
+              << "  --ladder-levels N           Ticks covered by the ladder window\n"
+              << "  --symbols A,B:0.05:100      Symbols to trade, one order book each, as NAME[:TICK[:LOT]]\n"
+              << "                              (default SIM, tick 0.01, lot 0.01)\n"
+              << "  --threads N                 Matching threads; symbols are spread across them\n"
+              << "  --cpus 0,2,4                Pin matching thread i to the i-th CPU in the list\n"
+              << "  --wait spin|park            Idle pipeline stages busy-spin, or spin then sleep (default park)\n"
+              << "  --queue-capacity N          Size of each pipeline ring (rounded up to a power of two)\n"
+              << "  --log-format text|binary    CSV logs written inline, or binary records written in the background\n"
+              << "  --journal PATH              Journal every request to PATH and replay it on startup\n"
+              << "  --journal-sync none|periodic|batch  When the journal is msync'ed (default periodic)\n"
+              << "  --journal-sync-ms N         Interval for periodic journal syncs (default 100)\n"
+              << "  --snapshot PATH             Snapshot file loaded on startup and written by the 'snapshot' command\n"
+              << "  --snapshot-every N          Also take a snapshot every N sequenced requests\n"
+              << "  --trace PATH                Write per-stage latencies of sampled requests to PATH as CSV\n"
+              << "  --trace-every N             Trace one request in N (default 1000)\n"
+              << "  --md-shm NAME               Publish trades and book updates to POSIX shared memory NAME\n"
+              << "  --md-capacity N             Messages kept in the shared memory ring (default 65536)\n"
+              << "  --gateway-shm NAME          Accept orders from other processes through POSIX shared memory NAME\n"
+              << "  --gateway-socket PATH       Accept orders from other processes on Unix domain socket PATH\n"
+              << "  --producers N               Background generator threads (default 1)\n"
+              << "  --rate R                    Total orders/sec across producers (default unlimited)\n"
+              << "  --flow uniform|market       Background prices uniform in a band, or quoted around a moving mid\n"
+              << "  --seed N                    Seed the background order flow (producer i uses N + i)\n"
+              << "  --poisson                   Poisson arrivals at --rate instead of a fixed pace\n"
+              << "  --cancel-ratio X            Share of background requests that cancel an earlier order\n"
+              << "  --headless                  Run a load test without the UI and print a summary\n"
+              << "  --duration S                Seconds a headless run generates orders (default 10)\n"
+              << "  --report PATH               JSON summary of a headless run (default logs/load_test.json)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
     std::cout << "🚀 Starting Market Order Simulator with Performance Benchmarking...\n";
     
+    EngineConfig config;
+    BookConfig& bookConfig = config.bookConfig;
+    size_t requestedThreads = 0;
+    LogFormat logFormat = LogFormat::TEXT;
+    GeneratorConfig generatorConfig;
+    LoadTestConfig loadTestConfig;
+    bool headless = false;
+    const size_t unlimitedSize = std::numeric_limits<size_t>::max();
+    const double unlimitedDouble = std::numeric_limits<double>::max();
+
+    for (int i = 1; i < argc; ++i) {
+        bool valid = true;
+        std::string arg = argv[i];
+        if (arg == "--book-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "map") {
+                bookConfig.backend = BookBackend::MAP;
+            } else if (backend == "ladder") {
+                bookConfig.backend = BookBackend::LADDER;
+            } else {
+                std::cerr << "Unknown book backend '" << backend << "', expected 'map' or 'ladder'\n";
+                return 1;
+            }
+        } else if (arg == "--ladder-levels" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], size_t{1}, size_t{1} << 24, bookConfig.ladderLevels);
+        } else if (arg == "--symbols" && i + 1 < argc) {
+            config.instruments.clear();
+            for (const std::string& spec : splitList(argv[++i])) {
+                Instrument instrument;
+                valid = valid && parseInstrument(spec, instrument);
+                config.instruments.push_back(instrument);
+            }
+            if (valid && config.instruments.empty()) {
+                std::cerr << "--symbols needs at least one symbol\n";
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], size_t{1}, unlimitedSize, requestedThreads);
+        } else if (arg == "--cpus" && i + 1 < argc) {
+            for (const std::string& cpu : splitList(argv[++i])) {
+                int index = 0;
+                valid = valid && parseFlag(arg, cpu, 0, std::numeric_limits<int>::max(), index);
+                config.cpuAffinity.push_back(index);
+            }
+        } else if (arg == "--wait" && i + 1 < argc) {
+            std::string wait = argv[++i];
+            if (wait == "spin") {
+                config.waitStrategy = WaitStrategy::BUSY_SPIN;
+            } else if (wait == "park") {
+                config.waitStrategy = WaitStrategy::SPIN_THEN_PARK;
+            } else {
+                std::cerr << "Unknown wait strategy '" << wait << "', expected 'spin' or 'park'\n";
+                return 1;
+            }
+        } else if (arg == "--queue-capacity" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], size_t{1}, MAX_RING_CAPACITY, config.queueCapacity);
+        } else if (arg == "--journal" && i + 1 < argc) {
+            config.journal.path = argv[++i];
+        } else if (arg == "--journal-sync" && i + 1 < argc) {
+            std::string sync = argv[++i];
+            if (sync == "none") {
+                config.journal.sync = JournalSync::NONE;
+            } else if (sync == "periodic") {
+                config.journal.sync = JournalSync::PERIODIC;
+            } else if (sync == "batch") {
+                config.journal.sync = JournalSync::PER_BATCH;
+            } else {
+                std::cerr << "Unknown journal sync policy '" << sync << "', expected 'none', 'periodic' or 'batch'\n";
+                return 1;
+            }
+        } else if (arg == "--journal-sync-ms" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], 1u, std::numeric_limits<unsigned>::max(), config.journal.syncIntervalMs);
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            config.snapshot.path = argv[++i];
+        } else if (arg == "--snapshot-every" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], uint64_t{0}, std::numeric_limits<uint64_t>::max(), config.snapshot.everyRequests);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            config.trace.path = argv[++i];
+        } else if (arg == "--trace-every" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], uint64_t{1}, std::numeric_limits<uint64_t>::max(), config.trace.sampleEvery);
+        } else if (arg == "--md-shm" && i + 1 < argc) {
+            config.marketDataFeed.name = argv[++i];
+        } else if (arg == "--md-capacity" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], size_t{1}, MAX_RING_CAPACITY, config.marketDataFeed.capacity);
+        } else if (arg == "--gateway-shm" && i + 1 < argc) {
+            config.gateway.shmName = argv[++i];
+        } else if (arg == "--gateway-socket" && i + 1 < argc) {
+            config.gateway.socketPath = argv[++i];
+        } else if (arg == "--producers" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], size_t{1}, unlimitedSize, generatorConfig.producers);
+        } else if (arg == "--rate" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], 0.0, unlimitedDouble, generatorConfig.ratePerSecond);
+        } else if (arg == "--flow" && i + 1 < argc) {
+            std::string flow = argv[++i];
+            if (flow == "uniform") {
+                generatorConfig.flow.model = FlowModel::UNIFORM;
+            } else if (flow == "market") {
+                generatorConfig.flow.model = FlowModel::MARKET;
+            } else {
+                std::cerr << "Unknown flow model '" << flow << "', expected 'uniform' or 'market'\n";
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], uint64_t{0}, std::numeric_limits<uint64_t>::max(), generatorConfig.flow.seed);
+        } else if (arg == "--poisson") {
+            generatorConfig.flow.poissonArrivals = true;
+        } else if (arg == "--cancel-ratio" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], 0.0, 1.0, generatorConfig.flow.cancelRatio);
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--duration" && i + 1 < argc) {
+            valid = parseFlag(arg, argv[++i], 0.001, unlimitedDouble, loadTestConfig.durationSeconds);
+        } else if (arg == "--report" && i + 1 < argc) {
+            loadTestConfig.reportPath = argv[++i];
+        } else if (arg == "--log-format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "text") {
+                logFormat = LogFormat::TEXT;
+            } else if (format == "binary") {
+                logFormat = LogFormat::BINARY;
+            } else {
+                std::cerr << "Unknown log format '" << format << "', expected 'text' or 'binary'\n";
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        if (!valid) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
     size_t hardware_threads = std::thread::hardware_concurrency();
-    size_t optimal_threads = std::max(static_cast<size_t>(4), hardware_threads);
+    size_t default_threads = std::max<size_t>(1, hardware_threads);
+    
+    // One matching thread per symbol at most: a book is never split across threads
+    config.shardCount = std::min(requestedThreads > 0 ? requestedThreads : default_threads, config.instruments.size());
     
     std::cout << "Hardware threads detected: " << hardware_threads << "\n";
-    std::cout << "Using " << optimal_threads << " worker threads\n";
+    std::cout << "Using " << config.shardCount << " matching thread(s) for " << config.instruments.size() << " symbol(s):";
+    for (const Instrument& instrument : config.instruments) {
+        std::cout << " " << instrument.symbol << " (tick " << instrument.tickSize << ", lot " << instrument.lotSize << ")";
+    }
+    std::cout << "\n";
+    std::cout << "Book backend: " << (bookConfig.backend == BookBackend::LADDER ? "ladder" : "map");
+    if (bookConfig.backend == BookBackend::LADDER) {
+        std::cout << " (" << bookConfig.ladderLevels << " levels)";
+    }
+    std::cout << "\n";
+    std::cout << "Timing clock: " << (TscClock::usesTsc() ? "invariant TSC" : "steady_clock (no invariant TSC)") << "\n";
     
-    Engine engine(optimal_threads);
+    if (logFormat == LogFormat::BINARY) {
+        Logger::getInstance().startBinary(config.instruments);
+        std::cout << "Logging binary records to logs/events.bin (decode with OrderLogDecoder)\n";
+    }
+
+    Engine engine(config);
+
+    if (!config.journal.path.empty() || !config.snapshot.path.empty()) {
+        RecoveryStats recovery;
+        std::string error;
+        if (!engine.recover(recovery, error)) {
+            std::cerr << "Recovery error: " << error << "\n";
+            return 1;
+        }
+
+        // Start this run's statistics clean, apart from the replay itself
+        Benchmark::getInstance().reset();
+        if (recovery.snapshotSequence > 0) {
+            std::cout << "Loaded snapshot at sequence " << recovery.snapshotSequence << " from " << config.snapshot.path
+                      << ": " << recovery.snapshotOrders << " orders in " << recovery.snapshotLoadMs << " ms\n";
+        }
+        if (!config.journal.path.empty()) {
+            Benchmark::getInstance().recordThroughput("Journal_Replay", static_cast<int>(recovery.requests), recovery.elapsedMs);
+            std::cout << "Replayed " << recovery.requests << " journaled requests from " << config.journal.path
+                      << " in " << recovery.elapsedMs << " ms";
+            if (recovery.elapsedMs > 0) {
+                std::cout << " (" << static_cast<long>(recovery.requests * 1000.0 / recovery.elapsedMs) << " requests/sec)";
+            }
+            std::cout << "\n";
+        }
+    }
+
     engine.start();
-    
+
+    BackgroundGenerator bgGenerator(engine, generatorConfig);
+
+    if (headless) {
+        std::cout << "Running headless load test for " << loadTestConfig.durationSeconds << "s with "
+                  << generatorConfig.producers << " producer(s)...\n";
+        LoadTest loadTest(engine, bgGenerator, loadTestConfig);
+        LoadTestReport report = loadTest.run();
+        Logger::getInstance().shutdown();
+
+        loadTest.print(report);
+        if (!loadTestConfig.reportPath.empty() && loadTest.writeJson(report)) {
+            std::cout << "Wrote " << loadTestConfig.reportPath << "\n";
+        }
+        Benchmark::getInstance().logBenchmarks();
+        return 0;
+    }
+
     std::cout << "Starting high-volume background trading simulation...\n";
-    
-    BackgroundGenerator bgGenerator(engine.getOrderBook());
     bgGenerator.start();
     std::cout << "Background generator started\n";
 
@@ -32,6 +365,7 @@ int main() {
     bgGenerator.stop();
     
     engine.stop();
+    Logger::getInstance().shutdown();
     
     Benchmark::getInstance().displayFinalReport();
 
@@ -1,154 +1,181 @@
 #include "order_book.hpp"
 #include "logger.hpp"
 #include "benchmark.hpp"
-#include <iostream>
 #include <algorithm>
-#include <functional>
 
 void OrderBook::match(const Order& order) {
-    auto updatePrice = [this](double price) {
-        setLastTradedPrice(price);
-    };
-    
-    match(order, updatePrice);
+    execute(order);
+    publishMarketData();
 }
 
-void OrderBook::match(const Order& order, const std::function<void(double)>& onMatchPrice) {
-    BENCHMARK_TIMER("OrderBook_Match");
-    
-    std::lock_guard<std::mutex> lock(orderBookMutex);
+// Matches one order, and any STOP orders its trades trigger, without
+// publishing market data in between
+void OrderBook::execute(const Order& order) {
+    BENCHMARK_TIMER(Timing::ORDERBOOK_MATCH);
     
     if (order.type == OrderType::STOP_LIMIT || order.type == OrderType::STOP_MARKET) {
         addToStopBook(order);
-        Logger::getInstance().logOrder(order);
-        Benchmark::getInstance().incrementCounter("Stop_Orders_Placed");
+        Logger::getInstance().logOrder(order, instrument);
+        BENCHMARK_COUNT(Counter::STOP_ORDERS_PLACED);
         
-        if (order.userId == 0) {
-            std::cout << "[STOP] Your " << ((order.type == OrderType::STOP_LIMIT) ? "STOP-LIMIT" : "STOP-MARKET")
-                      << " " << ((order.side == Side::BUY) ? "BUY" : "SELL")
-                      << " order placed. Will trigger when price " 
-                      << ((order.side == Side::BUY) ? ">=" : "<=") << " $" << order.triggerPrice << "\n";
+        if (wantsReport(order.userId)) {
+            ExecutionReport report = makeExecutionReport(ExecutionKind::ACCEPTED, order);
+            report.reference = order.triggerPrice;
+            pushReport(report);
         }
         return;
     }
     
     Order workingOrder = order;
     if (order.type == OrderType::ICEBERG) {
-        // For ICEBERG orders, process only the display quantity as a LIMIT order
-        workingOrder.quantity = order.displayQuantity;
+        // An incoming ICEBERG trades its whole size, hidden reserve included,
+        // against anything it crosses; only what is left rests as slices
+        workingOrder.quantity = order.totalQuantity;
         workingOrder.type = OrderType::LIMIT;
         
-        Logger::getInstance().logOrder(order);
-        Benchmark::getInstance().incrementCounter("Iceberg_Orders_Placed");
+        Logger::getInstance().logOrder(order, instrument);
+        BENCHMARK_COUNT(Counter::ICEBERG_ORDERS_PLACED);
     } else {
-        Logger::getInstance().logOrder(order);
-        Benchmark::getInstance().incrementCounter("Orders_Processed");
+        Logger::getInstance().logOrder(order, instrument);
+        BENCHMARK_COUNT(Counter::ORDERS_PROCESSED);
     }
 
-    double remainingQty = workingOrder.quantity;
-    double matchedPrice = 0.0;
+    Quantity remainingQty = workingOrder.quantity;
+    Price matchedPrice = 0;
     bool matched = false;
 
-    auto processQueue = [&](auto& queue, bool isBuy) {
+    auto processQueue = [&](OrderQueue& queue) {
         while (!queue.empty() && remainingQty > 0) {
-            Order& restingOrder = queue.front();
-            double tradeQty = std::min(remainingQty, restingOrder.quantity);
+            NodeIndex restingIndex = queue.front();
+            Order& restingOrder = pool[restingIndex].order;
+            Quantity tradeQty = std::min(remainingQty, restingOrder.quantity);
             matchedPrice = restingOrder.price;
             matched = true;
-            Logger::getInstance().logMatch(workingOrder, restingOrder, matchedPrice, tradeQty);
-            Benchmark::getInstance().incrementCounter("Orders_Matched");
-            Benchmark::getInstance().addToCounter("Volume_Traded", static_cast<long>(tradeQty * 100));
-            if (workingOrder.userId == 0) {
-                std::cout << (isBuy ? "[MATCH] You bought " : "[MATCH] You sold ") << tradeQty << " units @ $" << matchedPrice << "\n";
-            } else if (restingOrder.userId == 0) {
-                std::cout << (isBuy ? "[MATCH] Your resting BUY order executed: " : "[MATCH] Your resting SELL order executed: ") << tradeQty << " units @ $" << matchedPrice << "\n";
-            }
+            Logger::getInstance().logMatch(workingOrder, restingOrder, matchedPrice, tradeQty, instrument);
+            BENCHMARK_COUNT(Counter::ORDERS_MATCHED);
+            BENCHMARK_ADD(Counter::VOLUME_TRADED, static_cast<long>(tradeQty));
+            recordTrade(workingOrder.side, matchedPrice, tradeQty);
             remainingQty -= tradeQty;
             restingOrder.quantity -= tradeQty;
-            if (restingOrder.quantity <= 0) {
-                Order fullyExecutedOrder = restingOrder;
-                queue.pop_front();
-                refillIcebergOrder(fullyExecutedOrder, tradeQty, onMatchPrice);
+            queue.reduce(tradeQty);
+            bool icebergSlice = restingOrder.displayQuantity > 0;
+            if (icebergSlice) {
+                restingOrder.totalQuantity -= tradeQty;  // ICEBERG reserve, visible slice included
             }
-        }
-    };
 
-    auto matchLoop = [&](auto& book, bool reverse, bool isBuy) {
-        if (reverse) {
-            for (auto it = book.rbegin(); it != book.rend() && remainingQty > 0; ) {
-                double bookPrice = it->first;
-                bool priceMatches = (workingOrder.type == OrderType::MARKET) ? true : (workingOrder.price <= bookPrice);
-                if (!priceMatches) break;
-                auto& queue = it->second;
-                processQueue(queue, isBuy);
-                if (queue.empty()) {
-                    auto eraseIt = it.base();
-                    --eraseIt;
-                    it = std::reverse_iterator<decltype(book.erase(eraseIt))>(book.erase(eraseIt));
-                } else {
-                    ++it;
+            if (wantsFill(workingOrder.userId)) {
+                fillSink->push_back(Fill{matchedPrice, tradeQty, order.clientTag, order.id, order.userId,
+                                         order.side, false});
+            }
+            if (wantsFill(restingOrder.userId)) {
+                fillSink->push_back(Fill{matchedPrice, tradeQty, restingOrder.clientTag, restingOrder.id,
+                                         restingOrder.userId, restingOrder.side, true});
+            }
+            if (wantsReport(workingOrder.userId)) {
+                Quantity left = remainingQty;
+                ExecutionReport report = makeExecutionReport(
+                    left > 0 ? ExecutionKind::PARTIALLY_FILLED : ExecutionKind::FILLED, order);
+                report.price = matchedPrice;
+                report.quantity = tradeQty;
+                report.remaining = left;
+                pushReport(report);
+            }
+            if (wantsReport(restingOrder.userId)) {
+                Quantity left = icebergSlice ? restingOrder.totalQuantity : restingOrder.quantity;
+                ExecutionReport report = makeExecutionReport(
+                    left > 0 ? ExecutionKind::PARTIALLY_FILLED : ExecutionKind::FILLED, restingOrder);
+                report.price = matchedPrice;
+                report.quantity = tradeQty;
+                report.remaining = left;
+                report.action = order.action;
+                report.maker = true;
+                if (icebergSlice) {
+                    report.type = OrderType::ICEBERG;
                 }
+                pushReport(report);
             }
-        } else {
-            for (auto it = book.begin(); it != book.end() && remainingQty > 0; ) {
-                double bookPrice = it->first;
-                bool priceMatches = (workingOrder.type == OrderType::MARKET) ? true : (workingOrder.price >= bookPrice);
-                if (!priceMatches) break;
-                auto& queue = it->second;
-                processQueue(queue, isBuy);
-                if (queue.empty()) {
-                    it = book.erase(it);
-                } else {
-                    ++it;
+            if (restingOrder.quantity == 0) {
+                // A filled ICEBERG slice keeps its node and id and is requeued
+                // at the back of this level with the next slice
+                queue.popFront(pool);
+                if (!refillIceberg(restingIndex, queue)) {
+                    orderIndex.erase(restingOrder.id);
+                    pool.release(restingIndex);
                 }
             }
         }
     };
 
+    auto matchLoop = [&](BookSide& book, bool isBuy) {
+        Price bookPrice;
+        while (remainingQty > 0) {
+            BookSide::Level* queue = book.best(bookPrice);
+            if (queue == nullptr) break;
+            bool priceMatches = (workingOrder.type == OrderType::MARKET) ? true
+                              : (isBuy ? workingOrder.price >= bookPrice : workingOrder.price <= bookPrice);
+            if (!priceMatches) break;
+            processQueue(*queue);
+            depthChanged(isBuy ? Side::SELL : Side::BUY, bookPrice, queue->totalQuantity());
+            if (queue->empty()) {
+                book.erase(bookPrice);
+            }
+        }
+    };
+
     if (workingOrder.side == Side::BUY) {
-        matchLoop(asks, false, true);
+        matchLoop(asks, true);
     } else {
-        matchLoop(bids, true, false);
+        matchLoop(bids, false);
     }
 
     if (matched) {
-        onMatchPrice(matchedPrice);
-        checkStopTriggers(matchedPrice, onMatchPrice);
+        setLastTradedPrice(matchedPrice);
+        checkStopTriggers(matchedPrice);
     }
 
     if (remainingQty > 0) {
         if (order.type == OrderType::ICEBERG) {
             Order remainingOrder = order;
             remainingOrder.quantity = std::min(remainingQty, order.displayQuantity);
+            remainingOrder.totalQuantity = remainingQty;
             remainingOrder.type = OrderType::LIMIT;
-            if (order.side == Side::BUY) {
-                bids[order.price].push_back(remainingOrder);
-            } else {
-                asks[order.price].push_back(remainingOrder);
-            }
-            addToIcebergTrackingOnly(order);
-            Logger::getInstance().logRestingOrder(remainingOrder);
-            Benchmark::getInstance().incrementCounter("Orders_Resting");
-            if (order.userId == 0) {
-                std::cout << "[ICEBERG] Your ICEBERG " << ((order.side == Side::BUY) ? "BUY" : "SELL")
-                          << " order placed. Showing " << remainingOrder.quantity 
-                          << " of " << order.totalQuantity << " shares @ $" << order.price << "\n";
+            addToBook(remainingOrder);
+            Logger::getInstance().logRestingOrder(remainingOrder, instrument);
+            BENCHMARK_COUNT(Counter::ORDERS_RESTING);
+            if (wantsReport(order.userId)) {
+                ExecutionReport report = makeExecutionReport(ExecutionKind::RESTED, order);
+                report.quantity = remainingOrder.quantity;
+                report.remaining = remainingOrder.totalQuantity;
+                pushReport(report);
             }
         } else if (order.type == OrderType::LIMIT) {
             Order remainingOrder = order;
             remainingOrder.quantity = remainingQty;
-            if (order.side == Side::BUY) {
-                bids[order.price].push_back(remainingOrder);
-            } else {
-                asks[order.price].push_back(remainingOrder);
-            }
-            Logger::getInstance().logRestingOrder(remainingOrder);
-            Benchmark::getInstance().incrementCounter("Orders_Resting");
-            if (order.userId == 0) {
-                std::cout << "[RESTING] Your " << ((order.side == Side::BUY) ? "BUY" : "SELL")
-                          << " order for " << remainingQty << " units @ $" << order.price 
-                          << " is now in the order book waiting for a match.\n";
+            addToBook(remainingOrder);
+            Logger::getInstance().logRestingOrder(remainingOrder, instrument);
+            BENCHMARK_COUNT(Counter::ORDERS_RESTING);
+            if (wantsReport(order.userId)) {
+                ExecutionReport report = makeExecutionReport(ExecutionKind::RESTED, order);
+                report.quantity = remainingQty;
+                report.remaining = remainingQty;
+                pushReport(report);
             }
+        } else if (wantsReport(order.userId)) {
+            // A MARKET order never rests: what found no liquidity is gone, and
+            // the last fill report must not be left promising it
+            ExecutionReport report = makeExecutionReport(ExecutionKind::CANCELLED, order);
+            report.quantity = remainingQty;
+            pushReport(report);
         }
     }
 }
+
+NodeIndex OrderBook::addToBook(const Order& order) {
+    NodeIndex index = pool.allocate(order);
+    BookSide& book = (order.side == Side::BUY) ? bids : asks;
+    OrderQueue& level = book.level(order.price);
+    level.pushBack(pool, index);
+    orderIndex.insert(order.id, index);
+    depthChanged(order.side, order.price, level.totalQuantity());
+    return index;
+}
@@ -1,9 +1,71 @@
 #include "order_book.hpp"
+#include <algorithm>
 
-double OrderBook::getLastTradedPrice() const {
+OrderBook::OrderBook(const Instrument& instrument_, const BookConfig& config)
+    : instrument(instrument_),
+      pool(config.poolChunkSize, config.poolInitialCapacity),
+      asks(Side::SELL, config, instrument_.toTicks(instrument_.referencePrice)),
+      bids(Side::BUY, config, instrument_.toTicks(instrument_.referencePrice)),
+      last_traded_price(instrument_.toTicks(instrument_.referencePrice)),
+      depthSnapshotLevels(config.depthSnapshotLevels),
+      depthSnapshotInterval(config.depthSnapshotInterval) {
+    market.lastTrade = last_traded_price.load();
+    publishMarketData();
+}
+
+Price OrderBook::getLastTradedPrice() const {
     return last_traded_price.load();
 }
 
-void OrderBook::setLastTradedPrice(double price) {
+void OrderBook::setLastTradedPrice(Price price) {
     last_traded_price.store(price);
 }
+
+MarketData OrderBook::getMarketData() const {
+    return marketData.load();
+}
+
+void OrderBook::recordTrade(Side aggressor, Price price, Quantity quantity) {
+    if (depthRing != nullptr) {
+        pushDepth(DepthUpdate{0, price, quantity, depthSymbol, DepthUpdateKind::TRADE, aggressor});
+    }
+
+    if (market.trades == 0) {
+        market.high = price;
+        market.low = price;
+    } else {
+        market.high = std::max(market.high, price);
+        market.low = std::min(market.low, price);
+    }
+    market.lastTrade = price;
+    market.lastTradeSize = quantity;
+    market.volume += quantity;
+    ++market.trades;
+    tradedNotional += static_cast<double>(price) * static_cast<double>(quantity);
+    market.vwap = tradedNotional / static_cast<double>(market.volume);
+}
+
+// Called once at the end of each operation rather than per fill, so readers
+// see whole operations and a sweep pays for one store. Also the point where
+// a due depth snapshot goes out.
+void OrderBook::publishMarketData() {
+    Price price = 0;
+    BookSide::Level* level = bids.best(price);
+    market.bestBid = level ? price : 0;
+    market.bidSize = level ? level->totalQuantity() : 0;
+
+    level = asks.best(price);
+    market.bestAsk = level ? price : 0;
+    market.askSize = level ? level->totalQuantity() : 0;
+
+    ++market.updates;
+    marketData.store(market);
+
+    if (depthRing != nullptr && (depthResync || (depthSnapshotInterval > 0 && depthSinceSnapshot >= depthSnapshotInterval))) {
+        publishDepthSnapshot();
+    }
+}
+
+const Instrument& OrderBook::getInstrument() const {
+    return instrument;
+}
@@ -0,0 +1,81 @@
+#include "order_index.hpp"
+#include <cstdint>
+
+OrderIndex::OrderIndex(size_t initialCapacity) {
+    size_t capacity = 16;
+    while (capacity < initialCapacity * 2) {
+        capacity <<= 1;
+    }
+    slots.resize(capacity);
+    mask = capacity - 1;
+}
+
+size_t OrderIndex::home(int orderId) const {
+    // Fibonacci hashing spreads sequential ids across the table
+    uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(orderId)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(hash >> 32) & mask;
+}
+
+void OrderIndex::insert(int orderId, NodeIndex node) {
+    if ((count + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    for (size_t i = home(orderId);; i = (i + 1) & mask) {
+        if (slots[i].orderId == EMPTY) {
+            slots[i] = Slot{orderId, node};
+            ++count;
+            return;
+        }
+        if (slots[i].orderId == orderId) {
+            slots[i].node = node;
+            return;
+        }
+    }
+}
+
+NodeIndex OrderIndex::find(int orderId) const {
+    for (size_t i = home(orderId);; i = (i + 1) & mask) {
+        if (slots[i].orderId == orderId) {
+            return slots[i].node;
+        }
+        if (slots[i].orderId == EMPTY) {
+            return NULL_NODE;
+        }
+    }
+}
+
+void OrderIndex::erase(int orderId) {
+    size_t i = home(orderId);
+    while (slots[i].orderId != orderId) {
+        if (slots[i].orderId == EMPTY) {
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    // Shift later entries of the probe chain back into the hole
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask; slots[j].orderId != EMPTY; j = (j + 1) & mask) {
+        size_t want = home(slots[j].orderId);
+        bool movable = (hole <= j) ? (want <= hole || want > j) : (want <= hole && want > j);
+        if (movable) {
+            slots[hole] = slots[j];
+            hole = j;
+        }
+    }
+    slots[hole] = Slot{};
+    --count;
+}
+
+void OrderIndex::grow() {
+    std::vector<Slot> old = std::move(slots);
+    slots.assign(old.size() * 2, Slot{});
+    mask = slots.size() - 1;
+    count = 0;
+    for (const Slot& slot : old) {
+        if (slot.orderId != EMPTY) {
+            insert(slot.orderId, slot.node);
+        }
+    }
+}
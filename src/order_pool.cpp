@@ -0,0 +1,51 @@
+#include "order_pool.hpp"
+
+OrderPool::OrderPool(size_t chunkSize, size_t initialCapacity) : chunkShift(0) {
+    // Round the chunk size up to a power of two so indexing is a shift and a mask
+    while ((size_t{1} << chunkShift) < chunkSize) {
+        ++chunkShift;
+    }
+    chunkMask = static_cast<NodeIndex>((size_t{1} << chunkShift) - 1);
+
+    while (capacity() < initialCapacity) {
+        grow();
+    }
+}
+
+void OrderPool::grow() {
+    size_t chunkSize = size_t{1} << chunkShift;
+    NodeIndex first = static_cast<NodeIndex>(capacity());
+
+    chunks.emplace_back(new OrderNode[chunkSize]);
+    OrderNode* chunk = chunks.back().get();
+
+    // Thread the new nodes onto the free list in index order
+    for (size_t i = 0; i < chunkSize; ++i) {
+        chunk[i].next = (i + 1 < chunkSize) ? first + static_cast<NodeIndex>(i + 1) : freeHead;
+    }
+    freeHead = first;
+}
+
+NodeIndex OrderPool::allocate(const Order& order) {
+    if (freeHead == NULL_NODE) {
+        grow();
+    }
+
+    NodeIndex index = freeHead;
+    OrderNode& node = (*this)[index];
+    freeHead = node.next;
+
+    node.order = order;
+    node.prev = NULL_NODE;
+    node.next = NULL_NODE;
+    ++used;
+    return index;
+}
+
+void OrderPool::release(NodeIndex index) {
+    OrderNode& node = (*this)[index];
+    node.prev = NULL_NODE;
+    node.next = freeHead;
+    freeHead = index;
+    --used;
+}
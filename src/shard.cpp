@@ -0,0 +1,246 @@
+#include "shard.hpp"
+#include "benchmark.hpp"
+#include "gateway_protocol.hpp"
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+Shard::Shard(size_t index_, const ShardConfig& config_, Parker& resultParker_, SnapshotWriter* snapshotWriter_)
+    : index(index_),
+      config(config_),
+      inbox(config_.inboxCapacity),
+      inboxParker(config_.spinIterations),
+      results(config_.resultCapacity),
+      depthUpdates(config_.depthCapacity),
+      executions(config_.executionCapacity),
+      resultParker(resultParker_),
+      snapshotWriter(snapshotWriter_) {}
+
+Shard::~Shard() {
+    stop();
+}
+
+void Shard::addBook(SymbolId symbol, const Instrument& instrument, const BookConfig& bookConfig) {
+    if (books.size() <= symbol) {
+        books.resize(symbol + 1);
+    }
+    books[symbol] = std::make_unique<OrderBook>(instrument, bookConfig);
+    books[symbol]->attachDepthFeed(&depthUpdates, symbol);
+}
+
+OrderBook* Shard::getBook(SymbolId symbol) {
+    return (symbol < books.size()) ? books[symbol].get() : nullptr;
+}
+
+// Replayed requests were reported by the run that made them, so books only
+// report once the shard is live
+void Shard::start() {
+    for (size_t symbol = 0; symbol < books.size(); ++symbol) {
+        if (books[symbol]) {
+            books[symbol]->attachExecutionSink(&executions, static_cast<SymbolId>(symbol));
+            if (config.gatewayFills) {
+                books[symbol]->attachFillSink(&fills, GATEWAY_USER_BASE);
+            }
+        }
+    }
+    running = true;
+    worker = std::thread(&Shard::run, this);
+}
+
+void Shard::stop() {
+    running = false;
+    inboxParker.wakeAll();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void Shard::replay(const Order& order) {
+    process(order);
+}
+
+void Shard::submit(const Order& order) {
+    // A full inbox is backpressure on the sequencer
+    while (!inbox.tryPush(order)) {
+        inboxParker.notify();
+        cpuRelax();
+    }
+}
+
+void Shard::notify() {
+    inboxParker.notify();
+}
+
+size_t Shard::pollResults(OrderResult* out, size_t maxResults) {
+    return results.tryPopBatch(out, maxResults);
+}
+
+bool Shard::hasResults() const {
+    return !results.empty();
+}
+
+size_t Shard::pollDepth(DepthUpdate* out, size_t maxUpdates) {
+    return depthUpdates.tryPopBatch(out, maxUpdates);
+}
+
+bool Shard::hasDepthUpdates() const {
+    return !depthUpdates.empty();
+}
+
+size_t Shard::pollExecutions(ExecutionReport* out, size_t maxReports) {
+    return executions.tryPopBatch(out, maxReports);
+}
+
+size_t Shard::getInboxDepth() const {
+    return inbox.sizeApprox();
+}
+
+void Shard::run() {
+#ifdef __linux__
+    if (config.cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(config.cpu, &cpuset);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) != 0) {
+            std::cerr << "Warning: Could not pin shard " << index << " to CPU " << config.cpu << "\n";
+        }
+    }
+#endif
+
+    std::vector<Order> batch(config.batchSize);
+    unsigned idleSpins = 0;
+    while (true) {
+        size_t count = inbox.tryPopBatch(batch.data(), batch.size());
+
+        if (count == 0) {
+            // The sequencer stops before the shards, so an empty inbox after
+            // stop() means every sequenced order has been matched
+            if (!running && inbox.empty())
+                break;
+
+            inboxParker.wait(config.waitStrategy, idleSpins,
+                             [&]() { return !inbox.empty() || !running; });
+            continue;
+        }
+        idleSpins = 0;
+
+        // One clock read per order: each order is picked up when the one
+        // before it is done
+        Ticks pickedUp = TscClock::now();
+        for (size_t i = 0; i < count; ++i) {
+            const Order& order = batch[i];
+            bool accepted = process(order);
+            Ticks matched = TscClock::nowOrdered();
+            if (order.action != OrderAction::SNAPSHOT) {
+                BENCHMARK_TIMING(Timing::ORDER_PROCESSING, TscClock::elapsed(pickedUp, matched));
+            }
+
+            OrderStages stages = order.stages;
+            stages.pickedUp = OrderStages::offset(order.timestamp, pickedUp);
+            stages.matched = OrderStages::offset(order.timestamp, matched);
+            publish(OrderResult{order.sequence, order.id, order.userId, order.symbol,
+                                order.action, accepted, order.timestamp, stages, order.clientTag});
+            for (const Fill& fill : fills) {
+                OrderResult result{order.sequence, fill.orderId, fill.userId, order.symbol,
+                                   order.action, true, order.timestamp, stages, fill.clientTag};
+                result.kind = OrderResultKind::FILL;
+                result.price = fill.price;
+                result.quantity = fill.quantity;
+                result.side = fill.side;
+                result.maker = fill.maker;
+                publish(result);
+            }
+            fills.clear();
+            pickedUp = matched;
+        }
+        resultParker.notify();
+    }
+}
+
+void Shard::publish(const OrderResult& result) {
+    // A full result ring is backpressure from the publish stage
+    while (!results.tryPush(result)) {
+        resultParker.notify();
+        cpuRelax();
+    }
+}
+
+bool Shard::process(const Order& order) {
+    if (order.action == OrderAction::SNAPSHOT) {
+        takeSnapshot(order);
+        return true;
+    }
+
+    OrderBook* book = getBook(order.symbol);
+    if (book == nullptr) {
+        BENCHMARK_COUNT(Counter::ORDERS_REJECTED_UNKNOWN_SYMBOL);
+        return false;
+    }
+
+    switch (order.action) {
+        case OrderAction::NEW:
+            if (!isValidNewOrder(order)) {
+                BENCHMARK_COUNT(Counter::ORDERS_REJECTED_INVALID);
+                return false;
+            }
+            book->match(order);
+            return true;
+        case OrderAction::CANCEL: return book->cancel(order.id, order.userId);
+        case OrderAction::MODIFY:
+            if (!isValidModify(order)) {
+                BENCHMARK_COUNT(Counter::ORDERS_REJECTED_INVALID);
+                return false;
+            }
+            return book->modify(order.id, order.userId, order.price, order.quantity);
+        case OrderAction::SNAPSHOT: break;
+    }
+    return false;
+}
+
+// Orders from outside the process are checked here, so anything the book
+// would misread is refused before it gets there
+bool Shard::isValidNewOrder(const Order& order) {
+    if (order.quantity <= 0) {
+        return false;
+    }
+    switch (order.type) {
+        case OrderType::LIMIT: return order.price > 0;
+        case OrderType::MARKET: return true;
+        case OrderType::STOP_LIMIT: return order.price > 0 && order.triggerPrice > 0;
+        case OrderType::STOP_MARKET: return order.triggerPrice > 0;
+        case OrderType::ICEBERG:
+            return order.price > 0 && order.displayQuantity > 0 && order.totalQuantity >= order.displayQuantity;
+    }
+    return false;
+}
+
+// Whether a price is required depends on the order being amended, which
+// only the book knows, so the book makes the final check; a STOP_MARKET
+// amend carries price 0
+bool Shard::isValidModify(const Order& order) {
+    return order.quantity > 0 && order.price >= 0;
+}
+
+// Matching pauses only for as long as it takes to copy the books into memory;
+// the file is written by the snapshot writer thread
+void Shard::takeSnapshot(const Order& request) {
+    if (snapshotWriter == nullptr) {
+        return;
+    }
+
+    Ticks start = TscClock::now();
+    std::vector<char> state;
+    uint32_t bookCount = 0;
+    for (size_t symbol = 0; symbol < books.size(); ++symbol) {
+        if (books[symbol]) {
+            books[symbol]->saveSnapshot(static_cast<SymbolId>(symbol), state);
+            ++bookCount;
+        }
+    }
+    BENCHMARK_TIMING(Timing::SNAPSHOT_PAUSE, TscClock::elapsed(start, TscClock::nowOrdered()));
+
+    snapshotWriter->contribute(request.sequence, request.id, bookCount, std::move(state));
+}
@@ -0,0 +1,192 @@
+#include "shm_feed.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t SHM_FEED_MAGIC = 0x3144464D424F00ULL;  // "\0OBMFD1"
+constexpr uint32_t SHM_FEED_VERSION = 1;
+constexpr size_t MESSAGE_WORDS = sizeof(ShmFeedMessage) / sizeof(uint64_t);
+
+size_t slotsOffset() {
+    return (sizeof(ShmFeedHeader) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+}  // namespace
+
+ShmPublisher::ShmPublisher(const ShmFeedConfig& config_, const std::vector<Instrument>& instruments_)
+    : config(config_), instruments(instruments_) {}
+
+ShmPublisher::~ShmPublisher() {
+    close();
+}
+
+bool ShmPublisher::open(std::string& error) {
+    uint64_t capacity = 2;
+    while (capacity < config.capacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    mappedSize = slotsOffset() + capacity * sizeof(ShmFeedSlot);
+
+    // Subscribers of an earlier run keep their mapping of the old segment;
+    // new ones find this one
+    shm_unlink(config.name.c_str());
+    int fd = shm_open(config.name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        error = "could not create shared memory " + config.name + ": " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(mappedSize)) != 0) {
+        error = "could not size shared memory " + config.name + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(config.name.c_str());
+        return false;
+    }
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "could not map shared memory " + config.name + ": " + std::strerror(errno);
+        shm_unlink(config.name.c_str());
+        return false;
+    }
+
+    // The segment starts zero-filled, which is every slot empty
+    char* base = static_cast<char*>(mapping);
+    header = new (base) ShmFeedHeader();
+    header->magic = SHM_FEED_MAGIC;
+    header->version = SHM_FEED_VERSION;
+    header->messageSize = sizeof(ShmFeedMessage);
+    header->capacity = capacity;
+    header->symbolCount = static_cast<uint32_t>(std::min(instruments.size(), SHM_FEED_MAX_SYMBOLS));
+    header->usesTsc = TscClock::usesTsc() ? 1 : 0;
+    for (uint32_t i = 0; i < header->symbolCount; ++i) {
+        ShmFeedSymbol& symbol = header->symbols[i];
+        std::strncpy(symbol.name, instruments[i].symbol.c_str(), sizeof(symbol.name) - 1);
+        symbol.tickSize = instruments[i].tickSize;
+        symbol.lotSize = instruments[i].lotSize;
+    }
+    header->writeSequence.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_release);
+    slots = reinterpret_cast<ShmFeedSlot*>(base + slotsOffset());
+    return true;
+}
+
+void ShmPublisher::publish(const DepthUpdate& update) {
+    ShmFeedMessage message;
+    message.sequence = ++sequence;
+    message.bookSequence = update.sequence;
+    message.published = TscClock::now();
+    message.price = update.price;
+    message.quantity = update.quantity;
+    message.symbol = update.symbol;
+    message.kind = update.kind;
+    message.side = update.side;
+    std::memset(message.reserved, 0, sizeof(message.reserved));
+
+    uint64_t words[MESSAGE_WORDS];
+    std::memcpy(words, &message, sizeof(message));
+
+    ShmFeedSlot& slot = slots[sequence & mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < MESSAGE_WORDS; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(sequence, std::memory_order_release);
+    header->writeSequence.store(sequence, std::memory_order_release);
+}
+
+void ShmPublisher::close() {
+    if (header == nullptr) {
+        return;
+    }
+    header->closed.store(1, std::memory_order_release);
+    munmap(header, mappedSize);
+    shm_unlink(config.name.c_str());
+    header = nullptr;
+    slots = nullptr;
+}
+
+ShmSubscriber::~ShmSubscriber() {
+    if (header != nullptr) {
+        munmap(const_cast<ShmFeedHeader*>(header), mappedSize);
+    }
+}
+
+bool ShmSubscriber::open(const std::string& name, std::string& error) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        error = "could not open shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < slotsOffset()) {
+        error = name + " is not a market data feed";
+        ::close(fd);
+        return false;
+    }
+    mappedSize = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "could not map shared memory " + name + ": " + std::strerror(errno);
+        return false;
+    }
+
+    header = static_cast<const ShmFeedHeader*>(mapping);
+    if (header->magic != SHM_FEED_MAGIC || header->version != SHM_FEED_VERSION ||
+        header->messageSize != sizeof(ShmFeedMessage) ||
+        mappedSize < slotsOffset() + header->capacity * sizeof(ShmFeedSlot)) {
+        error = name + " is not a market data feed written by this version";
+        munmap(mapping, mappedSize);
+        header = nullptr;
+        return false;
+    }
+    slots = reinterpret_cast<const ShmFeedSlot*>(static_cast<const char*>(mapping) + slotsOffset());
+    mask = header->capacity - 1;
+    next = header->writeSequence.load(std::memory_order_acquire) + 1;
+    return true;
+}
+
+// The slot for message `next` holds it, an older message (not written yet),
+// a newer one or 0 mid-write (overwritten: lapped). A copy is only kept if
+// the slot still holds `next` after it was taken.
+ShmSubscriber::ReadStatus ShmSubscriber::poll(ShmFeedMessage& out) {
+    const ShmFeedSlot& slot = slots[next & mask];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (sequence == next) {
+        uint64_t words[MESSAGE_WORDS];
+        for (size_t i = 0; i < MESSAGE_WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == next) {
+            std::memcpy(&out, words, sizeof(out));
+            ++next;
+            return ReadStatus::MESSAGE;
+        }
+    } else if (sequence != 0 && sequence < next) {
+        if (header->closed.load(std::memory_order_acquire) != 0 &&
+            header->writeSequence.load(std::memory_order_acquire) < next) {
+            return ReadStatus::CLOSED;
+        }
+        return ReadStatus::EMPTY;
+    } else if (sequence == 0 && header->writeSequence.load(std::memory_order_acquire) < next) {
+        // Never written, or being written with `next` right now
+        return header->closed.load(std::memory_order_acquire) != 0 ? ReadStatus::CLOSED : ReadStatus::EMPTY;
+    }
+
+    uint64_t newest = header->writeSequence.load(std::memory_order_acquire);
+    lost += newest + 1 - next;
+    next = newest + 1;
+    return ReadStatus::LAPPED;
+}
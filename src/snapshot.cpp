@@ -0,0 +1,187 @@
+#include "snapshot.hpp"
+#include "benchmark.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr uint64_t SNAPSHOT_MAGIC = 0x31504E53424F0000;  // "\0\0OBSNP1"
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+}
+
+SnapshotOrder toSnapshotOrder(const Order& order) {
+    SnapshotOrder record;
+    std::memset(&record, 0, sizeof(record));
+    record.id = order.id;
+    record.userId = order.userId;
+    record.price = order.price;
+    record.quantity = order.quantity;
+    record.triggerPrice = order.triggerPrice;
+    record.totalQuantity = order.totalQuantity;
+    record.displayQuantity = order.displayQuantity;
+    record.type = static_cast<uint8_t>(order.type);
+    record.side = static_cast<uint8_t>(order.side);
+    record.symbol = order.symbol;
+    return record;
+}
+
+Order fromSnapshotOrder(const SnapshotOrder& record) {
+    Order order{};
+    order.id = record.id;
+    order.userId = record.userId;
+    order.type = static_cast<OrderType>(record.type);
+    order.side = static_cast<Side>(record.side);
+    order.price = record.price;
+    order.quantity = record.quantity;
+    order.triggerPrice = record.triggerPrice;
+    order.totalQuantity = record.totalQuantity;
+    order.displayQuantity = record.displayQuantity;
+    order.timestamp = TscClock::now();
+    order.symbol = record.symbol;
+    return order;
+}
+
+bool readSnapshotFile(const std::string& path, uint64_t layoutHash, std::vector<char>& data, std::string& error) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "could not open " + path;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size < static_cast<std::streamsize>(sizeof(SnapshotFileHeader))) {
+        error = path + " is too short to be a snapshot";
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(data.data(), size)) {
+        error = "could not read " + path;
+        return false;
+    }
+
+    SnapshotFileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+        error = path + " is not a snapshot written by this version";
+        return false;
+    }
+    if (header.layoutHash != layoutHash) {
+        error = path + " was written for a different set of symbols";
+        return false;
+    }
+    return true;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path_, uint64_t layoutHash_, size_t shardCount_)
+    : path(path_), layoutHash(layoutHash_), shardCount(shardCount_) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    stop();
+}
+
+void SnapshotWriter::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = true;
+    }
+    writerThread = std::thread(&SnapshotWriter::run, this);
+}
+
+void SnapshotWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cv.notify_all();
+
+    if (writerThread.joinable())
+        writerThread.join();
+}
+
+void SnapshotWriter::contribute(uint64_t sequence, int64_t nextOrderId, uint32_t bookCount, std::vector<char>&& books) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Pending& snapshot = pending[sequence];
+        snapshot.nextOrderId = nextOrderId;
+        snapshot.bookCount += bookCount;
+        snapshot.books.insert(snapshot.books.end(), books.begin(), books.end());
+
+        if (++snapshot.contributions < shardCount) {
+            return;
+        }
+        ready.emplace_back(sequence, std::move(snapshot));
+        pending.erase(sequence);
+    }
+    cv.notify_one();
+}
+
+uint64_t SnapshotWriter::getLastWrittenSequence() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastWrittenSequence;
+}
+
+void SnapshotWriter::run() {
+    while (true) {
+        std::pair<uint64_t, Pending> next;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return !ready.empty() || !running; });
+
+            if (ready.empty())
+                break;
+
+            next = std::move(ready.front());
+            ready.pop_front();
+        }
+
+        if (write(next.first, next.second)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lastWrittenSequence = next.first;
+        }
+    }
+}
+
+bool SnapshotWriter::write(uint64_t sequence, const Pending& snapshot) {
+    BENCHMARK_TIMER(Timing::SNAPSHOT_WRITE);
+
+    SnapshotFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.bookCount = snapshot.bookCount;
+    header.sequence = sequence;
+    header.layoutHash = layoutHash;
+    header.nextOrderId = snapshot.nextOrderId;
+
+    // Written next to the target and renamed over it, so a crash mid-write
+    // leaves the previous snapshot intact
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Warning: Could not write snapshot " << tempPath << "\n";
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(snapshot.books.data(), static_cast<std::streamsize>(snapshot.books.size()));
+        if (!file) {
+            std::cerr << "Warning: Could not write snapshot " << tempPath << "\n";
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::cerr << "Warning: Could not replace snapshot " << path << ": " << ec.message() << "\n";
+        return false;
+    }
+    BENCHMARK_COUNT(Counter::SNAPSHOTS_WRITTEN);
+    return true;
+}
@@ -1,141 +1,99 @@
 #include "order_book.hpp"
 #include "logger.hpp"
 #include "benchmark.hpp"
-#include <iostream>
+#include <iterator>
 
 void OrderBook::addToStopBook(const Order& order) {
+    NodeIndex index = pool.allocate(order);
     if (order.side == Side::SELL) {
-        stopAsks[order.triggerPrice].push_back(order);
+        stopAsks[order.triggerPrice].pushBack(pool, index);
     } else {
-        stopBids[order.triggerPrice].push_back(order);
+        stopBids[order.triggerPrice].pushBack(pool, index);
     }
+    orderIndex.insert(order.id, index);
 }
 
-void OrderBook::checkStopTriggers(double lastTradePrice, const std::function<void(double)>& onMatchPrice) {
-    BENCHMARK_TIMER("Stop_Trigger_Check");
-    
-    for (auto it = stopAsks.begin(); it != stopAsks.end();) {
-        double triggerPrice = it->first;
-        
-        if (lastTradePrice <= triggerPrice) {
-            auto& stopOrders = it->second;
-            
-            while (!stopOrders.empty()) {
-                Order triggeredOrder = stopOrders.front();
-                stopOrders.pop_front();
-                
-                if (triggeredOrder.type == OrderType::STOP_MARKET) {
-                    triggeredOrder.type = OrderType::MARKET;
-                    triggeredOrder.price = 0.0;  // Market orders don't need price
-                } else {
-                    // Price collar check
-                    if (triggeredOrder.side == Side::SELL) {
-                        if (triggeredOrder.price > lastTradePrice * 1.05) {
-                            if (triggeredOrder.userId == 0) {
-                                std::cout << "[ORDER REJECTED] Your STOP SELL limit $" << triggeredOrder.price 
-                                          << " exceeds maximum allowed deviation from market price $" << lastTradePrice 
-                                          << " (exchange price collar violation)\n";
-                            }
-                            Benchmark::getInstance().incrementCounter("Stop_Orders_Rejected");
-                            continue;  
-                        } else {
-                            triggeredOrder.type = OrderType::LIMIT;
-                        }
-                    } else {
-                        if (triggeredOrder.price < lastTradePrice * 0.95) {
-                            if (triggeredOrder.userId == 0) {
-                                std::cout << "[ORDER REJECTED] Your STOP BUY limit $" << triggeredOrder.price 
-                                          << " exceeds maximum allowed deviation from market price $" << lastTradePrice 
-                                          << " (exchange price collar violation)\n";
-                            }
-                            Benchmark::getInstance().incrementCounter("Stop_Orders_Rejected");
-                            continue; 
-                        } else {
-                            triggeredOrder.type = OrderType::LIMIT;
-                        }
-                    }
-                }
-                
-                Benchmark::getInstance().incrementCounter("Stop_Orders_Triggered");
-                
-                if (triggeredOrder.userId == 0) {
-                    std::cout << "[STOP TRIGGERED] Your STOP " 
-                              << ((triggeredOrder.side == Side::BUY) ? "BUY" : "SELL")
-                              << " triggered at $" << lastTradePrice 
-                              << " -> executing " << ((triggeredOrder.type == OrderType::MARKET) ? "MARKET" : "LIMIT")
-                              << " order\n";
-                }
-                
-                match(triggeredOrder, onMatchPrice);
+// Turns a triggered STOP into the order it releases. STOP_LIMIT prices too
+// far from the trade that triggered them are rejected by the price collar.
+bool OrderBook::releaseStop(Order& triggeredOrder, Price lastTradePrice) {
+    if (triggeredOrder.type == OrderType::STOP_MARKET) {
+        triggeredOrder.type = OrderType::MARKET;
+        triggeredOrder.price = 0;  // Market orders don't need price
+    } else {
+        // Price collar check
+        bool outsideCollar = (triggeredOrder.side == Side::SELL) ? triggeredOrder.price * 100 > lastTradePrice * 105
+                                                                 : triggeredOrder.price * 100 < lastTradePrice * 95;
+        if (outsideCollar) {
+            if (wantsReport(triggeredOrder.userId)) {
+                ExecutionReport report = makeExecutionReport(ExecutionKind::REJECTED, triggeredOrder);
+                report.reference = lastTradePrice;
+                report.reason = RejectReason::PRICE_COLLAR;
+                pushReport(report);
             }
-            
-            it = stopAsks.erase(it);  
-        } else {
-            ++it;
+            BENCHMARK_COUNT(Counter::STOP_ORDERS_REJECTED);
+            return false;
         }
+        triggeredOrder.type = OrderType::LIMIT;
     }
     
-    for (auto it = stopBids.rbegin(); it != stopBids.rend();) {
-        double triggerPrice = it->first;
+    BENCHMARK_COUNT(Counter::STOP_ORDERS_TRIGGERED);
+    
+    if (wantsReport(triggeredOrder.userId)) {
+        ExecutionReport report = makeExecutionReport(ExecutionKind::TRIGGERED, triggeredOrder);
+        report.reference = lastTradePrice;
+        pushReport(report);
+    }
+    return true;
+}
+
+// Moves every order of one trigger level onto the work queue, in time order
+void OrderBook::queueTriggeredLevel(OrderQueue& stopOrders, Price lastTradePrice) {
+    while (!stopOrders.empty()) {
+        NodeIndex stopIndex = stopOrders.popFront(pool);
+        Order triggeredOrder = pool[stopIndex].order;
+        orderIndex.erase(triggeredOrder.id);
+        pool.release(stopIndex);
         
-        if (lastTradePrice >= triggerPrice) {
-            auto& stopOrders = it->second;
-            
-            while (!stopOrders.empty()) {
-                Order triggeredOrder = stopOrders.front();
-                stopOrders.pop_front();
-                
-                if (triggeredOrder.type == OrderType::STOP_MARKET) {
-                    triggeredOrder.type = OrderType::MARKET;
-                    triggeredOrder.price = 0.0;  // Market orders don't need price
-                } else {
-                    // Price collar check
-                    if (triggeredOrder.side == Side::SELL) {
-                        if (triggeredOrder.price > lastTradePrice * 1.05) {
-                            if (triggeredOrder.userId == 0) {
-                                std::cout << "[ORDER REJECTED] Your STOP SELL limit $" << triggeredOrder.price 
-                                          << " exceeds maximum allowed deviation from market price $" << lastTradePrice 
-                                          << " (exchange price collar violation)\n";
-                            }
-                            Benchmark::getInstance().incrementCounter("Stop_Orders_Rejected");
-                            continue;  
-                        } else {
-                            triggeredOrder.type = OrderType::LIMIT;
-                        }
-                    } else {
-                        if (triggeredOrder.price < lastTradePrice * 0.95) {
-                            if (triggeredOrder.userId == 0) {
-                                std::cout << "[ORDER REJECTED] Your STOP BUY limit $" << triggeredOrder.price 
-                                          << " exceeds maximum allowed deviation from market price $" << lastTradePrice 
-                                          << " (exchange price collar violation)\n";
-                            }
-                            Benchmark::getInstance().incrementCounter("Stop_Orders_Rejected");
-                            continue; 
-                        } else {
-                            triggeredOrder.type = OrderType::LIMIT;
-                        }
-                    }
-                }
-                
-                Benchmark::getInstance().incrementCounter("Stop_Orders_Triggered");
-                
-                if (triggeredOrder.userId == 0) {
-                    std::cout << "[STOP TRIGGERED] Your STOP " 
-                              << ((triggeredOrder.side == Side::BUY) ? "BUY" : "SELL")
-                              << " triggered at $" << lastTradePrice 
-                              << " -> executing " << ((triggeredOrder.type == OrderType::MARKET) ? "MARKET" : "LIMIT")
-                              << " order\n";
-                }
-                
-                match(triggeredOrder, onMatchPrice);
-            }
-            
-            auto forwardIt = std::next(it).base();
-            stopBids.erase(forwardIt);
-            break;
-        } else {
-            ++it;
+        if (releaseStop(triggeredOrder, lastTradePrice)) {
+            triggeredStops.push_back(triggeredOrder);
         }
     }
 }
 
+// Only the levels a trade at `lastTradePrice` crosses are visited: SELL stops
+// with a trigger at or above it and BUY stops with a trigger at or below it.
+// Triggered orders go on a FIFO work queue that the outermost call drains.
+// Trades made while draining queue their own triggers behind it instead of
+// recursing, so a cascade costs time in the orders it triggers and never
+// grows the stack.
+void OrderBook::checkStopTriggers(Price lastTradePrice) {
+    {
+        BENCHMARK_TIMER(Timing::STOP_TRIGGER_CHECK);
+        
+        // Nearest the market first: lowest SELL trigger upward, highest BUY trigger downward
+        auto firstAsk = stopAsks.lower_bound(lastTradePrice);
+        for (auto it = firstAsk; it != stopAsks.end(); ++it) {
+            queueTriggeredLevel(it->second, lastTradePrice);
+        }
+        stopAsks.erase(firstAsk, stopAsks.end());
+        
+        auto endBid = stopBids.upper_bound(lastTradePrice);
+        for (auto it = std::make_reverse_iterator(endBid); it != stopBids.rend(); ++it) {
+            queueTriggeredLevel(it->second, lastTradePrice);
+        }
+        stopBids.erase(stopBids.begin(), endBid);
+    }
+    
+    if (drainingStops) {
+        return;
+    }
+    
+    drainingStops = true;
+    for (size_t next = 0; next < triggeredStops.size(); ++next) {
+        // Copied out: matching it may grow the queue
+        Order triggeredOrder = triggeredStops[next];
+        execute(triggeredOrder);
+    }
+    triggeredStops.clear();
+    drainingStops = false;
+}
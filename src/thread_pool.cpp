@@ -1,41 +0,0 @@
-#include "thread_pool.hpp"
-
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
-    for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(&ThreadPool::workerThread, this);
-    }
-}
-
-ThreadPool::~ThreadPool() {
-    stop = true;
-    condition.notify_all();
-    for (std::thread &worker : workers) {
-        worker.join();
-    }
-}
-
-void ThreadPool::enqueue(std::function<void()> task) {
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.push(std::move(task));
-    }
-    condition.notify_one();
-}
-
-void ThreadPool::workerThread() {
-    while (!stop) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            condition.wait(lock, [this] {
-                return stop || !tasks.empty();
-            });
-            if (stop && tasks.empty()) {
-                return;
-            }
-            task = std::move(tasks.front());
-            tasks.pop();
-        }
-        task();
-    }
-}
\ No newline at end of file
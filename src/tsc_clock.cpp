@@ -0,0 +1,67 @@
+#include "tsc_clock.hpp"
+#include <thread>
+
+#if defined(ORDERBOOK_HAS_RDTSC) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+namespace {
+
+// CPUID leaf 0x80000007, EDX bit 8: the TSC ticks at a constant rate in
+// every P- and C-state, so it can stand in for wall time
+bool detectInvariantTsc() {
+#if defined(ORDERBOOK_HAS_RDTSC) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+        return false;
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(ORDERBOOK_HAS_RDTSC)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007u)
+        return false;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+// Shortest stretch the TSC is measured over; steady_clock's own jitter is
+// then well below a part per million
+constexpr auto MIN_CALIBRATION = std::chrono::milliseconds(50);
+
+}  // namespace
+
+const bool TscClock::tscEnabled = detectInvariantTsc();
+
+namespace {
+
+// Taken at startup, so by the time anything is reported the calibration
+// interval has usually already passed and costs nothing
+const Ticks referenceTicks = TscClock::now();
+const auto referenceTime = std::chrono::steady_clock::now();
+
+double calibrate() {
+    auto elapsed = std::chrono::steady_clock::now() - referenceTime;
+    if (elapsed < MIN_CALIBRATION) {
+        std::this_thread::sleep_for(MIN_CALIBRATION - elapsed);
+    }
+
+    Ticks ticks = TscClock::now();
+    auto time = std::chrono::steady_clock::now();
+    double nanos = std::chrono::duration<double, std::nano>(time - referenceTime).count();
+    return nanos / static_cast<double>(ticks - referenceTicks);
+}
+
+}  // namespace
+
+double TscClock::nanosPerTick() {
+    if (!tscEnabled)
+        return 1.0;
+
+    static const double ratio = calibrate();
+    return ratio;
+}
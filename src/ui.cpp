@@ -2,13 +2,15 @@
 #include "benchmark.hpp"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 UI::UI(Engine& engine_) 
     : engine(engine_),
       running(false),
-      orderId(1000000) {
+      symbol(0),
+      reporter(engine_) {
 }
 
 UI::~UI() {
@@ -18,7 +20,9 @@ UI::~UI() {
 void UI::start() {
     if (!running.load()) {
         running.store(true);
+        reporter.start();
         interactiveInput();
+        reporter.stop();
         running.store(false);
     }
 }
@@ -41,9 +45,14 @@ void UI::interactiveInput() {
     std::cout << "- <BUY/SELL> <LIMIT/MARKET> <price> <quantity> : Place an order\n";
     std::cout << "- <BUY/SELL> <STOP_LIMIT/STOP_MARKET> <trigger_price> <limit_price> <quantity> : Place a STOP order\n";
     std::cout << "- <BUY/SELL> <ICEBERG> <price> <total_quantity> <display_quantity> : Place an ICEBERG order\n";
-    std::cout << "- price : Show current last traded price\n";
+    std::cout << "- CANCEL <order_id> : Cancel one of your resting or pending orders\n";
+    std::cout << "- MODIFY <order_id> <price> <quantity> : Change price/quantity of one of your orders\n";
+    std::cout << "- SYMBOL <name> : Switch the symbol that orders and prices apply to\n";
+    std::cout << "- price : Show last trade, best bid/ask, session high/low, VWAP and volume\n";
+    std::cout << "- depth <N> : Show the best N price levels of each side (up to 20)\n";
     std::cout << "- help : Show detailed help\n";
     std::cout << "- stats : Show performance statistics\n";
+    std::cout << "- snapshot : Save every order book to the snapshot file\n";
     std::cout << "- quit : Exit the simulator\n";
     std::cout << "Examples:\n";
     std::cout << "  BUY LIMIT 100.5 10        - Buy at $100.50 or better\n";
@@ -64,8 +73,82 @@ void UI::interactiveInput() {
         }
 
         if (sideStr == "price" || sideStr == "PRICE") {
-            double currentPrice = engine.getOrderBook().getLastTradedPrice();
-            std::cout << "💰 Last Traded Price: $" << std::fixed << std::setprecision(2) << currentPrice << "\n";
+            const OrderBook& orderBook = engine.getOrderBook(symbol);
+            const Instrument& instrument = orderBook.getInstrument();
+            MarketData market = orderBook.getMarketData();
+            double currentPrice = instrument.toPrice(orderBook.getLastTradedPrice());
+            std::cout << std::fixed << std::setprecision(2);
+            std::cout << "💰 Last Traded Price (" << instrument.symbol << "): $" << currentPrice << "\n";
+            std::cout << "   Bid: ";
+            if (market.hasBid()) {
+                std::cout << instrument.toQuantity(market.bidSize) << " @ $" << instrument.toPrice(market.bestBid);
+            } else {
+                std::cout << "-";
+            }
+            std::cout << "   Ask: ";
+            if (market.hasAsk()) {
+                std::cout << instrument.toQuantity(market.askSize) << " @ $" << instrument.toPrice(market.bestAsk);
+            } else {
+                std::cout << "-";
+            }
+            if (market.hasBid() && market.hasAsk()) {
+                std::cout << "   Spread: $" << instrument.toPrice(market.bestAsk - market.bestBid);
+            }
+            std::cout << "\n";
+            if (market.trades > 0) {
+                std::cout << "   High: $" << instrument.toPrice(market.high) << "   Low: $" << instrument.toPrice(market.low)
+                          << "   VWAP: $" << market.vwap * instrument.tickSize
+                          << "   Volume: " << instrument.toQuantity(market.volume) << " (" << market.trades << " trades)\n";
+            }
+            continue;
+        }
+
+        if (sideStr == "depth" || sideStr == "DEPTH") {
+            int levels = 0;
+            if (!(std::cin >> levels) || levels <= 0) {
+                std::cout << "Invalid format. Use: DEPTH <levels>\n";
+                std::cin.clear();
+                std::cin.ignore(10000, '\n');
+                continue;
+            }
+            size_t shown = std::min<size_t>(static_cast<size_t>(levels), DEPTH_VIEW_LEVELS);
+            const Instrument& instrument = engine.getInstrument(symbol);
+            DepthLevels depth = engine.getDepth(symbol);
+
+            std::cout << std::fixed << std::setprecision(2);
+            std::cout << "📚 Depth (" << instrument.symbol << ", top " << shown << ")"
+                      << (depth.synced ? "" : " [resyncing]") << "\n";
+            std::cout << std::setw(12) << "Bid Qty" << std::setw(12) << "Bid" << "  |  "
+                      << std::left << std::setw(12) << "Ask" << std::setw(12) << "Ask Qty" << std::right << "\n";
+            for (size_t i = 0; i < shown && (i < depth.bidCount || i < depth.askCount); ++i) {
+                if (i < depth.bidCount) {
+                    std::cout << std::setw(12) << instrument.toQuantity(depth.bids[i].quantity)
+                              << std::setw(12) << instrument.toPrice(depth.bids[i].price);
+                } else {
+                    std::cout << std::setw(24) << "";
+                }
+                std::cout << "  |  " << std::left;
+                if (i < depth.askCount) {
+                    std::cout << std::setw(12) << instrument.toPrice(depth.asks[i].price)
+                              << std::setw(12) << instrument.toQuantity(depth.asks[i].quantity);
+                }
+                std::cout << std::right << "\n";
+            }
+            continue;
+        }
+
+        if (sideStr == "symbol" || sideStr == "SYMBOL") {
+            std::string name;
+            std::cin >> name;
+            if (!engine.findSymbol(name, symbol)) {
+                std::cout << "Unknown symbol '" << name << "'. Available:";
+                for (size_t i = 0; i < engine.getSymbolCount(); ++i) {
+                    std::cout << " " << engine.getInstrument(static_cast<SymbolId>(i)).symbol;
+                }
+                std::cout << "\n";
+                continue;
+            }
+            std::cout << "✓ Now trading " << name << "\n";
             continue;
         }
 
@@ -89,7 +172,15 @@ void UI::interactiveInput() {
             std::cout << "• ICEBERG orders: Hide large order size by showing only small portions\n";
             std::cout << "  - Only display_quantity is visible in the order book\n";
             std::cout << "  - When visible portion fills, more shares automatically appear\n";
-            std::cout << "  - Format: BUY/SELL ICEBERG <price> <total_quantity> <display_quantity>\n\n";
+            std::cout << "  - Format: BUY/SELL ICEBERG <price> <total_quantity> <display_quantity>\n";
+            std::cout << "• CANCEL: Remove one of your resting LIMIT, ICEBERG or pending STOP orders\n";
+            std::cout << "  - Format: CANCEL <order_id>\n";
+            std::cout << "• MODIFY: Change the price and/or quantity of one of your orders\n";
+            std::cout << "  - Reducing quantity at the same price keeps your place in the queue\n";
+            std::cout << "  - Any other change moves the order to the back of the queue\n";
+            std::cout << "  - For ICEBERG orders the quantity is the new total size\n";
+            std::cout << "  - STOP-MARKET orders have no limit price; any positive price keeps them unchanged\n";
+            std::cout << "  - Format: MODIFY <order_id> <price> <quantity>\n\n";
             std::cout << "Examples:\n";
             std::cout << "  BUY LIMIT 95.50 10              - Buy 10 units at $95.50 or better\n";
             std::cout << "  SELL MARKET 0 5                 - Sell 5 units at best available price\n";
@@ -107,6 +198,52 @@ void UI::interactiveInput() {
 
         if (sideStr == "stats" || sideStr == "STATS") {
             Benchmark::getInstance().displayRealTimeStats();
+            std::cout << "Pipeline: " << engine.getSequencedCount() << " sequenced, "
+                      << engine.getPublishedSequence() << " highest published, "
+                      << engine.getQueueDepth() << " queued\n";
+            continue;
+        }
+
+        if (sideStr == "snapshot" || sideStr == "SNAPSHOT") {
+            if (engine.requestSnapshot()) {
+                std::cout << "📸 Snapshot requested (last written at sequence " << engine.getLastSnapshotSequence() << ")\n";
+            } else {
+                std::cout << "Snapshots are disabled; start with --snapshot <path>\n";
+            }
+            continue;
+        }
+
+        if (sideStr == "cancel" || sideStr == "CANCEL") {
+            int cancelId;
+            if (!(std::cin >> cancelId)) {
+                std::cout << "Invalid format. Use: CANCEL <order_id>\n";
+                std::cin.clear();
+                std::cin.ignore(10000, '\n');
+                continue;
+            }
+            engine.cancelOrder(cancelId, 0, symbol);
+            std::cout << "✓ Cancel requested for order #" << cancelId << "\n";
+            continue;
+        }
+
+        if (sideStr == "modify" || sideStr == "MODIFY") {
+            int modifyId;
+            double newPrice;
+            double newQty;
+            if (!(std::cin >> modifyId >> newPrice >> newQty)) {
+                std::cout << "Invalid format. Use: MODIFY <order_id> <price> <quantity>\n";
+                std::cin.clear();
+                std::cin.ignore(10000, '\n');
+                continue;
+            }
+            const Instrument& instrument = engine.getOrderBook(symbol).getInstrument();
+            if (newPrice <= 0 || instrument.toLots(newQty) <= 0) {
+                std::cout << "Price must be positive and quantity must be at least one lot (" << instrument.lotSize << ").\n";
+                continue;
+            }
+            engine.modifyOrder(modifyId, instrument.toTicks(newPrice), instrument.toLots(newQty), 0, symbol);
+            std::cout << "✓ Modify requested for order #" << modifyId << ": " << std::fixed << std::setprecision(2)
+                      << newQty << " @ $" << newPrice << "\n";
             continue;
         }
 
@@ -164,6 +301,8 @@ void UI::interactiveInput() {
             }
         }
 
+        const Instrument& instrument = engine.getOrderBook(symbol).getInstrument();
+
         // Validation
         if (isIcebergOrder) {
             if (totalQty <= 0 || displayQty <= 0) {
@@ -178,10 +317,17 @@ void UI::interactiveInput() {
                 std::cout << "Price must be positive for ICEBERG orders.\n";
                 continue;
             }
+            if (instrument.toLots(displayQty) <= 0) {
+                std::cout << "Display quantity must be at least one lot (" << instrument.lotSize << ").\n";
+                continue;
+            }
             qty = totalQty;  // Set qty for the order creation
         } else if (qty <= 0) {
             std::cout << "Quantity must be positive.\n";
             continue;
+        } else if (instrument.toLots(qty) <= 0) {
+            std::cout << "Quantity must be at least one lot (" << instrument.lotSize << ").\n";
+            continue;
         }
 
         if (isStopOrder) {
@@ -195,7 +341,7 @@ void UI::interactiveInput() {
             }
             
             if (typeStr == "STOP_LIMIT") {
-                double currentPrice = engine.getOrderBook().getLastTradedPrice();
+                double currentPrice = instrument.toPrice(engine.getOrderBook(symbol).getLastTradedPrice());
                 if (side == Side::SELL && price > currentPrice * 1.10) {
                     std::cout << "⚠️  WARNING: Your SELL limit $" << price << " is " 
                               << std::fixed << std::setprecision(1) << ((price/currentPrice - 1) * 100) 
@@ -230,24 +376,26 @@ void UI::interactiveInput() {
             orderType = OrderType::ICEBERG;
         }
 
+        int submittedId = engine.nextOrderId();
         Order order {
-            orderId++,
+            submittedId,
             0,
             orderType,
             side,
-            price,
-            qty,
-            triggerPrice,
-            isIcebergOrder ? totalQty : 0.0,
-            isIcebergOrder ? displayQty : 0.0,
-            std::chrono::high_resolution_clock::now()
+            instrument.toTicks(price),
+            instrument.toLots(qty),
+            instrument.toTicks(triggerPrice),
+            isIcebergOrder ? instrument.toLots(totalQty) : 0,
+            isIcebergOrder ? instrument.toLots(displayQty) : 0,
+            TscClock::now()
         };
+        order.symbol = symbol;
 
         engine.submitOrder(order);
-        Benchmark::getInstance().incrementCounter("User_Orders_Submitted");
+        BENCHMARK_COUNT(Counter::USER_ORDERS_SUBMITTED);
         
         if (isStopOrder) {
-            std::cout << "✓ STOP Order submitted: " << sideStr << " " << typeStr 
+            std::cout << "✓ STOP Order #" << submittedId << " submitted: " << sideStr << " " << typeStr 
                       << " - Trigger: $" << std::fixed << std::setprecision(2) << triggerPrice;
             if (typeStr == "STOP_LIMIT") {
                 std::cout << " → Limit: $" << price;
@@ -255,16 +403,16 @@ void UI::interactiveInput() {
             std::cout << " - Qty: " << qty << "\n";
             std::cout << "🎯 Your STOP order is now monitoring price movements...\n";
         } else if (isIcebergOrder) {
-            std::cout << "✓ ICEBERG Order submitted: " << sideStr << " " << typeStr 
+            std::cout << "✓ ICEBERG Order #" << submittedId << " submitted: " << sideStr << " " << typeStr 
                       << " - Total: " << std::fixed << std::setprecision(0) << totalQty 
                       << " - Display: " << displayQty << " @ $" << std::setprecision(2) << price << "\n";
             std::cout << "🧊 Your ICEBERG order is hiding " << (totalQty - displayQty) << " shares behind the scenes...\n";
         } else {
             if (orderType == OrderType::MARKET) {
-                double currentPrice = engine.getOrderBook().getLastTradedPrice();
-                std::cout << "✓ Order submitted: " << sideStr << " " << typeStr << " " << qty << " @ Market ($" << std::fixed << std::setprecision(2) << currentPrice << ")\n";
+                double currentPrice = instrument.toPrice(engine.getOrderBook(symbol).getLastTradedPrice());
+                std::cout << "✓ Order #" << submittedId << " submitted: " << sideStr << " " << typeStr << " " << qty << " @ Market ($" << std::fixed << std::setprecision(2) << currentPrice << ")\n";
             } else {
-                std::cout << "✓ Order submitted: " << sideStr << " " << typeStr << " " << qty << " @ $" << std::fixed << std::setprecision(2) << price << "\n";
+                std::cout << "✓ Order #" << submittedId << " submitted: " << sideStr << " " << typeStr << " " << qty << " @ $" << std::fixed << std::setprecision(2) << price << "\n";
             }
         }
     }
@@ -0,0 +1,123 @@
+// Checks that the console user's execution reports end in what the book
+// actually holds: whatever a fill report says is left either rests or is
+// reported gone. Run through ctest.
+
+#include "order_book.hpp"
+#include "console_reporter.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <iostream>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (false)
+
+const int OTHER_USER = 1001;
+
+Order makeOrder(int id, int userId, OrderType type, Side side, Price price, Quantity quantity) {
+    Order order;
+    order.id = id;
+    order.userId = userId;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+std::vector<ExecutionReport> drain(SpscRing<ExecutionReport>& ring) {
+    std::vector<ExecutionReport> reports(ring.capacity());
+    reports.resize(ring.tryPopBatch(reports.data(), reports.size()));
+    return reports;
+}
+
+// A partially filled ICEBERG taker reports the rest it still has, then
+// rests exactly that
+void icebergTakerRests() {
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(64);
+    book.attachExecutionSink(&ring, 0);
+    book.match(makeOrder(1, OTHER_USER, OrderType::LIMIT, Side::SELL, 10000, 50));
+
+    Order iceberg = makeOrder(2, CONSOLE_USER_ID, OrderType::ICEBERG, Side::BUY, 10000, 100);
+    iceberg.totalQuantity = 100;
+    iceberg.displayQuantity = 10;
+    book.match(iceberg);
+
+    std::vector<ExecutionReport> reports = drain(ring);
+    CHECK(reports.size() == 2);
+    if (reports.size() == 2) {
+        CHECK(reports[0].kind == ExecutionKind::PARTIALLY_FILLED);
+        CHECK(reports[0].quantity == 50);
+        CHECK(reports[0].remaining == 50);
+        CHECK(reports[1].kind == ExecutionKind::RESTED);
+        CHECK(reports[1].quantity == 10);
+        CHECK(reports[1].remaining == 50);
+    }
+    CHECK(book.cancel(2, CONSOLE_USER_ID));
+}
+
+// A MARKET order that runs out of liquidity reports the unfilled rest as
+// cancelled rather than leaving it promised
+void marketRemainderCancelled() {
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(64);
+    book.attachExecutionSink(&ring, 0);
+    book.match(makeOrder(1, OTHER_USER, OrderType::LIMIT, Side::SELL, 10000, 20));
+    book.match(makeOrder(2, CONSOLE_USER_ID, OrderType::MARKET, Side::BUY, 0, 30));
+
+    std::vector<ExecutionReport> reports = drain(ring);
+    CHECK(reports.size() == 2);
+    if (reports.size() == 2) {
+        CHECK(reports[0].kind == ExecutionKind::PARTIALLY_FILLED);
+        CHECK(reports[0].remaining == 10);
+        CHECK(reports[1].kind == ExecutionKind::CANCELLED);
+        CHECK(reports[1].quantity == 10);
+        CHECK(reports[1].remaining == 0);
+        CHECK(ConsoleReporter::render(reports[1], book.getInstrument()).find("[UNFILLED]") == 0);
+    }
+    CHECK(book.getMarketData().bestBid == 0);
+}
+
+// With nothing to trade against, the whole MARKET order is reported cancelled
+void marketWithoutLiquidity() {
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(64);
+    book.attachExecutionSink(&ring, 0);
+    book.match(makeOrder(1, CONSOLE_USER_ID, OrderType::MARKET, Side::SELL, 0, 30));
+
+    std::vector<ExecutionReport> reports = drain(ring);
+    CHECK(reports.size() == 1);
+    if (reports.size() == 1) {
+        CHECK(reports[0].kind == ExecutionKind::CANCELLED);
+        CHECK(reports[0].quantity == 30);
+    }
+}
+
+}  // namespace
+
+int main() {
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    icebergTakerRests();
+    marketRemainderCancelled();
+    marketWithoutLiquidity();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All execution report checks passed\n";
+    return 0;
+}
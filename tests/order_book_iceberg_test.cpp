@@ -0,0 +1,128 @@
+// Checks that an ICEBERG order entering the book, new or re-entered by a
+// modify, trades its hidden reserve and rests whatever is left of it.
+// Run through ctest.
+
+#include "order_book.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (false)
+
+const int BUYER = 1;
+const int SELLER = 2;
+
+Order makeOrder(int id, int userId, OrderType type, Side side, Price price, Quantity quantity) {
+    Order order;
+    order.id = id;
+    order.userId = userId;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+Order makeIceberg(int id, int userId, Side side, Price price, Quantity total, Quantity display) {
+    Order order = makeOrder(id, userId, OrderType::ICEBERG, side, price, total);
+    order.totalQuantity = total;
+    order.displayQuantity = display;
+    return order;
+}
+
+// 100/10 BUY ICEBERG against SELL 50: all 50 trade and the other 50 rest
+// as a 10 lot slice that later sellers can fill completely
+void takerTradesReserve() {
+    OrderBook book;
+    book.match(makeOrder(1, SELLER, OrderType::LIMIT, Side::SELL, 10000, 50));
+    book.match(makeIceberg(2, BUYER, Side::BUY, 10000, 100, 10));
+
+    MarketData market = book.getMarketData();
+    CHECK(market.volume == 50);
+    CHECK(market.bestAsk == 0);
+    CHECK(market.bestBid == 10000);
+    CHECK(market.bidSize == 10);
+
+    book.match(makeOrder(3, SELLER, OrderType::LIMIT, Side::SELL, 10000, 60));
+    market = book.getMarketData();
+    CHECK(market.volume == 100);
+    CHECK(market.bestBid == 0);
+    CHECK(market.bestAsk == 10000);
+    CHECK(market.askSize == 10);
+    CHECK(!book.cancel(2, BUYER));
+}
+
+// What rests after a partial fill is still one order that can be cancelled
+void restingRemainderCancels() {
+    OrderBook book;
+    book.match(makeOrder(1, SELLER, OrderType::LIMIT, Side::SELL, 10000, 50));
+    book.match(makeIceberg(2, BUYER, Side::BUY, 10000, 100, 10));
+    CHECK(book.cancel(2, BUYER));
+    MarketData market = book.getMarketData();
+    CHECK(market.bestBid == 0);
+    CHECK(market.volume == 50);
+}
+
+// A taker that fills completely leaves nothing behind
+void takerFillsCompletely() {
+    OrderBook book;
+    book.match(makeOrder(1, SELLER, OrderType::LIMIT, Side::SELL, 10000, 150));
+    book.match(makeIceberg(2, BUYER, Side::BUY, 10000, 100, 10));
+    MarketData market = book.getMarketData();
+    CHECK(market.volume == 100);
+    CHECK(market.bestBid == 0);
+    CHECK(market.askSize == 50);
+    CHECK(!book.cancel(2, BUYER));
+}
+
+// A resting iceberg amended to a crossing price re-enters with its whole
+// reserve rather than only its visible slice
+void modifyReentryTradesReserve() {
+    OrderBook book;
+    book.match(makeIceberg(1, BUYER, Side::BUY, 9900, 100, 10));
+    book.match(makeOrder(2, SELLER, OrderType::LIMIT, Side::SELL, 10000, 50));
+
+    CHECK(book.modify(1, BUYER, 10000, 100));
+    MarketData market = book.getMarketData();
+    CHECK(market.volume == 50);
+    CHECK(market.bestAsk == 0);
+    CHECK(market.bestBid == 10000);
+    CHECK(market.bidSize == 10);
+
+    book.match(makeOrder(3, SELLER, OrderType::LIMIT, Side::SELL, 10000, 50));
+    market = book.getMarketData();
+    CHECK(market.volume == 100);
+    CHECK(market.bestBid == 0);
+    CHECK(market.bestAsk == 0);
+    CHECK(!book.cancel(1, BUYER));
+}
+
+}  // namespace
+
+int main() {
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    takerTradesReserve();
+    restingRemainderCancels();
+    takerFillsCompletely();
+    modifyReentryTradesReserve();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All iceberg checks passed\n";
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Checks that OrderBook::modify refuses amendments a new order would be
+// refused for and leaves the book as it was. Run through ctest.
+
+#include "order_book.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <iostream>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (false)
+
+const int BUYER = 1;
+const int SELLER = 2;
+const int ASK_ID = 100;
+
+Order makeOrder(int id, int userId, OrderType type, Side side, Price price, Quantity quantity) {
+    Order order;
+    order.id = id;
+    order.userId = userId;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+// Ten-lot bids on five levels from 10000 down and one SELL 50 @ 20000
+void buildBook(OrderBook& book) {
+    for (int level = 0; level < 5; ++level) {
+        book.match(makeOrder(level + 1, BUYER, OrderType::LIMIT, Side::BUY, 10000 - level * 10, 10));
+    }
+    book.match(makeOrder(ASK_ID, SELLER, OrderType::LIMIT, Side::SELL, 20000, 50));
+}
+
+void checkUntouched(const OrderBook& book) {
+    MarketData market = book.getMarketData();
+    CHECK(market.bestBid == 10000);
+    CHECK(market.bidSize == 10);
+    CHECK(market.bestAsk == 20000);
+    CHECK(market.askSize == 50);
+    CHECK(market.volume == 0);
+    CHECK(market.trades == 0);
+    CHECK(book.getLastTradedPrice() == book.getInstrument().toTicks(book.getInstrument().referencePrice));
+}
+
+void rejectsNonPositivePrice() {
+    for (Price price : {Price{0}, Price{-1}, Price{-20000}}) {
+        OrderBook book;
+        buildBook(book);
+        CHECK(!book.modify(ASK_ID, SELLER, price, 50));
+        checkUntouched(book);
+
+        // The order is still resting and can be amended with valid values
+        CHECK(book.modify(ASK_ID, SELLER, 20000, 40));
+        CHECK(book.getMarketData().askSize == 40);
+    }
+}
+
+void rejectsNonPositiveQuantity() {
+    OrderBook book;
+    buildBook(book);
+    CHECK(!book.modify(ASK_ID, SELLER, 20000, 0));
+    CHECK(!book.modify(ASK_ID, SELLER, 20000, -5));
+    checkUntouched(book);
+}
+
+void rejectsNonPositiveIcebergPrice() {
+    OrderBook book;
+    buildBook(book);
+    Order iceberg = makeOrder(200, SELLER, OrderType::ICEBERG, Side::SELL, 19000, 5);
+    iceberg.displayQuantity = 5;
+    iceberg.totalQuantity = 30;
+    book.match(iceberg);
+    CHECK(!book.modify(200, SELLER, 0, 30));
+    MarketData market = book.getMarketData();
+    CHECK(market.bestBid == 10000);
+    CHECK(market.bestAsk == 19000);
+    CHECK(market.volume == 0);
+}
+
+// STOP_MARKET orders have no limit price, so price 0 is their normal amend
+void acceptsStopMarketWithoutPrice() {
+    OrderBook book;
+    buildBook(book);
+    Order stop = makeOrder(300, SELLER, OrderType::STOP_MARKET, Side::SELL, 0, 10);
+    stop.triggerPrice = 9000;
+    book.match(stop);
+    CHECK(book.modify(300, SELLER, 0, 5));
+    checkUntouched(book);
+}
+
+}  // namespace
+
+int main() {
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    rejectsNonPositivePrice();
+    rejectsNonPositiveQuantity();
+    rejectsNonPositiveIcebergPrice();
+    acceptsStopMarketWithoutPrice();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All modify checks passed\n";
+    return 0;
+}
@@ -0,0 +1,259 @@
+// Checks that Engine::recover rebuilds a book holding resting, STOP and
+// ICEBERG orders exactly as the run that journaled it left it, both from the
+// journal alone and from a snapshot plus the journal tail. Run through ctest.
+
+#include "engine.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (false)
+
+const int TRADER = 5;
+
+EngineConfig makeConfig(const std::filesystem::path& directory, bool snapshots) {
+    EngineConfig config;
+    config.journal.path = (directory / "orders.journal").string();
+    config.journal.sync = JournalSync::PER_BATCH;
+    config.journal.growBytes = 1 << 20;
+    if (snapshots) {
+        config.snapshot.path = (directory / "books.snapshot").string();
+    }
+    return config;
+}
+
+// Submits one request and returns its order id
+int submit(Engine& engine, OrderType type, Side side, Price price, Quantity quantity,
+           Price triggerPrice = 0, Quantity displayQuantity = 0) {
+    Order order;
+    order.id = engine.nextOrderId();
+    order.userId = TRADER;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    order.triggerPrice = triggerPrice;
+    if (type == OrderType::ICEBERG) {
+        order.totalQuantity = quantity;
+        order.displayQuantity = displayQuantity;
+    }
+    order.timestamp = TscClock::now();
+    engine.submitOrder(order);
+    return order.id;
+}
+
+void submitCancel(Engine& engine, int orderId) {
+    Order request;
+    request.id = orderId;
+    request.userId = TRADER;
+    request.action = OrderAction::CANCEL;
+    request.timestamp = TscClock::now();
+    engine.submitOrder(request);
+}
+
+// Waits until `requests` requests of a fresh run have been matched and
+// published, so the snapshot lands where the test expects it
+void drain(Engine& engine, uint64_t requests) {
+    while (engine.getPublishedSequence() < requests) {
+        usleep(100);
+    }
+}
+
+// Builds a book with resting LIMITs on both sides, two partly filled
+// ICEBERGs, STOPs on either side of the market and a cancel, snapshotting
+// halfway when `snapshot` is set. Returns every id it used.
+std::vector<int> runSession(Engine& engine, bool snapshot) {
+    std::vector<int> ids;
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::BUY, 9990, 10));
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::BUY, 9980, 10));
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::BUY, 9980, 6));
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::SELL, 10010, 10));
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::SELL, 10020, 10));
+    ids.push_back(submit(engine, OrderType::ICEBERG, Side::SELL, 10030, 60, 0, 10));
+    ids.push_back(submit(engine, OrderType::ICEBERG, Side::BUY, 9970, 50, 0, 5));
+    ids.push_back(submit(engine, OrderType::STOP_LIMIT, Side::SELL, 9940, 7, 9950));
+    ids.push_back(submit(engine, OrderType::STOP_MARKET, Side::BUY, 0, 3, 10100));
+    // Takes both asks and half the ICEBERG's first slice
+    ids.push_back(submit(engine, OrderType::MARKET, Side::BUY, 0, 25));
+
+    if (snapshot) {
+        uint64_t before = engine.getLastSnapshotSequence();
+        drain(engine, ids.size());
+        CHECK(engine.requestSnapshot());
+        while (engine.getLastSnapshotSequence() == before) {
+            usleep(100);
+        }
+    }
+
+    // The journal tail: trades into the bids and through several refills of
+    // the resting ICEBERG, and changes the resting orders
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::SELL, 9990, 4));
+    ids.push_back(submit(engine, OrderType::ICEBERG, Side::BUY, 10030, 30, 0, 10));
+    ids.push_back(submit(engine, OrderType::LIMIT, Side::BUY, 9960, 5));
+    ids.push_back(submit(engine, OrderType::STOP_LIMIT, Side::BUY, 10210, 4, 10200));
+    submitCancel(engine, ids[1]);
+    return ids;
+}
+
+std::unique_ptr<Engine> runOriginal(const std::filesystem::path& directory, bool snapshot,
+                                    std::vector<int>& ids) {
+    auto engine = std::make_unique<Engine>(makeConfig(directory, snapshot));
+    RecoveryStats stats;
+    std::string error;
+    CHECK(engine->recover(stats, error));
+    engine->start();
+    ids = runSession(*engine, snapshot);
+    engine->stop();
+    return engine;
+}
+
+std::unique_ptr<Engine> recoverCopy(const std::filesystem::path& directory, bool snapshot,
+                                    RecoveryStats& stats) {
+    auto engine = std::make_unique<Engine>(makeConfig(directory, snapshot));
+    std::string error;
+    CHECK(engine->recover(stats, error));
+    if (!error.empty()) {
+        std::cerr << error << "\n";
+    }
+    return engine;
+}
+
+void checkSameBook(const MarketData& original, const MarketData& recovered) {
+    CHECK(original.bestBid == recovered.bestBid);
+    CHECK(original.bidSize == recovered.bidSize);
+    CHECK(original.bestAsk == recovered.bestAsk);
+    CHECK(original.askSize == recovered.askSize);
+    CHECK(original.lastTrade == recovered.lastTrade);
+}
+
+// Session statistics aren't in snapshots, so they only match after a replay
+// of the whole journal
+void checkSameSession(const MarketData& original, const MarketData& recovered) {
+    CHECK(original.volume == recovered.volume);
+    CHECK(original.trades == recovered.trades);
+    CHECK(original.high == recovered.high);
+    CHECK(original.low == recovered.low);
+}
+
+// Cancels every id on both books in turn: each must be resting (or a STOP)
+// on both or on neither, and the top of book must agree after every step
+void checkCancelEveryId(OrderBook& original, OrderBook& recovered, const std::vector<int>& ids) {
+    for (int id : ids) {
+        bool cancelled = original.cancel(id, TRADER);
+        CHECK(recovered.cancel(id, TRADER) == cancelled);
+        checkSameBook(original.getMarketData(), recovered.getMarketData());
+    }
+    MarketData market = recovered.getMarketData();
+    CHECK(!market.hasBid());
+    CHECK(!market.hasAsk());
+}
+
+Order makeSweep(int id, Side side) {
+    Order order;
+    order.id = id;
+    order.userId = TRADER;
+    order.type = OrderType::MARKET;
+    order.side = side;
+    order.quantity = 1000;
+    return order;
+}
+
+// Sweeps both sides with MARKET orders: hidden ICEBERG reserve and any STOP
+// the sweep triggers must trade the same on both books
+void checkSameSweep(OrderBook& original, OrderBook& recovered) {
+    Quantity originalVolume = original.getMarketData().volume;
+    Quantity recoveredVolume = recovered.getMarketData().volume;
+    int id = 1000000;
+    for (Side side : {Side::SELL, Side::BUY}) {
+        original.match(makeSweep(id, side));
+        recovered.match(makeSweep(id, side));
+        ++id;
+        checkSameBook(original.getMarketData(), recovered.getMarketData());
+        CHECK(original.getMarketData().volume - originalVolume ==
+              recovered.getMarketData().volume - recoveredVolume);
+    }
+}
+
+void checkRecovery(const std::filesystem::path& root, bool snapshot) {
+    std::filesystem::path directory = root / (snapshot ? "snapshot" : "journal");
+    std::filesystem::path sweepDirectory = root / (snapshot ? "snapshot-sweep" : "journal-sweep");
+
+    std::vector<int> ids;
+    auto original = runOriginal(directory, snapshot, ids);
+    if (snapshot) {
+        CHECK(original->getLastSnapshotSequence() > 0);
+    }
+    RecoveryStats stats;
+    auto recovered = recoverCopy(directory, snapshot, stats);
+    if (snapshot) {
+        CHECK(stats.snapshotSequence == original->getLastSnapshotSequence());
+        CHECK(stats.snapshotOrders > 0);
+        CHECK(stats.requests == 5);
+    } else {
+        CHECK(stats.snapshotSequence == 0);
+        CHECK(stats.requests == ids.size() + 1);
+    }
+
+    MarketData before = original->getOrderBook(0).getMarketData();
+    MarketData after = recovered->getOrderBook(0).getMarketData();
+    CHECK(before.hasBid());
+    CHECK(before.hasAsk());
+    checkSameBook(before, after);
+    if (!snapshot) {
+        checkSameSession(before, after);
+    }
+    CHECK(original->getOrderBook(0).getLastTradedPrice() == recovered->getOrderBook(0).getLastTradedPrice());
+    // New ids carry on past every id the journal holds
+    CHECK(recovered->nextOrderId() > ids.back());
+
+    // The original engine is stopped, so its book can be driven directly
+    checkCancelEveryId(original->getOrderBook(0), recovered->getOrderBook(0), ids);
+
+    // A second identical run, swept instead of cancelled
+    std::vector<int> sweepIds;
+    auto sweepOriginal = runOriginal(sweepDirectory, snapshot, sweepIds);
+    RecoveryStats sweepStats;
+    auto sweepRecovered = recoverCopy(sweepDirectory, snapshot, sweepStats);
+    checkSameSweep(sweepOriginal->getOrderBook(0), sweepRecovered->getOrderBook(0));
+}
+
+}  // namespace
+
+int main() {
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    std::filesystem::path root = std::filesystem::temp_directory_path() /
+                                 ("orderbook_recovery_test." + std::to_string(getpid()));
+    std::filesystem::remove_all(root);
+
+    checkRecovery(root, false);
+    checkRecovery(root, true);
+
+    std::filesystem::remove_all(root);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All recovery checks passed\n";
+    return 0;
+}
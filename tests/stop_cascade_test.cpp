@@ -0,0 +1,176 @@
+// Checks the order in which triggered STOPs execute: nearest trigger first,
+// time order within a trigger level, and stops triggered while a cascade is
+// draining queued behind the ones already triggered. Run through ctest.
+
+#include "order_book.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include <iostream>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "      \
+                      << #condition << "\n";                                    \
+            ++failures;                                                         \
+        }                                                                       \
+    } while (false)
+
+const int OTHER_USER = 1001;
+
+Order makeOrder(int id, int userId, OrderType type, Side side, Price price, Quantity quantity) {
+    Order order;
+    order.id = id;
+    order.userId = userId;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+Order makeStop(int id, Side side, Price triggerPrice) {
+    Order order = makeOrder(id, CONSOLE_USER_ID, OrderType::STOP_MARKET, side, 0, 1);
+    order.triggerPrice = triggerPrice;
+    return order;
+}
+
+std::vector<ExecutionReport> drain(SpscRing<ExecutionReport>& ring) {
+    std::vector<ExecutionReport> reports(ring.capacity());
+    reports.resize(ring.tryPopBatch(reports.data(), reports.size()));
+    return reports;
+}
+
+struct Expected {
+    ExecutionKind kind;
+    int orderId;
+    Price price;   // Fills only
+};
+
+void checkReports(const std::vector<ExecutionReport>& reports, const std::vector<Expected>& expected) {
+    CHECK(reports.size() == expected.size());
+    for (size_t i = 0; i < reports.size() && i < expected.size(); ++i) {
+        CHECK(reports[i].kind == expected[i].kind);
+        CHECK(reports[i].orderId == expected[i].orderId);
+        if (expected[i].kind == ExecutionKind::FILLED) {
+            CHECK(reports[i].price == expected[i].price);
+        }
+    }
+}
+
+// One trade at 9990 triggers the SELL stops at 9990 (two, in time order)
+// and 9995. All three are triggered before any of them trades, and the stop
+// at 9960 that their trades trigger runs after them.
+void sellCascade() {
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(64);
+    book.attachExecutionSink(&ring, 0);
+    book.match(makeOrder(1, OTHER_USER, OrderType::LIMIT, Side::BUY, 9990, 1));
+    book.match(makeOrder(2, OTHER_USER, OrderType::LIMIT, Side::BUY, 9970, 2));
+    book.match(makeOrder(3, OTHER_USER, OrderType::LIMIT, Side::BUY, 9950, 10));
+    book.match(makeStop(21, Side::SELL, 9995));
+    book.match(makeStop(22, Side::SELL, 9990));
+    book.match(makeStop(23, Side::SELL, 9990));
+    book.match(makeStop(24, Side::SELL, 9960));
+    book.match(makeStop(25, Side::SELL, 9940));
+    drain(ring);
+
+    book.match(makeOrder(4, OTHER_USER, OrderType::MARKET, Side::SELL, 0, 1));
+    checkReports(drain(ring), {
+        {ExecutionKind::TRIGGERED, 22, 0},
+        {ExecutionKind::TRIGGERED, 23, 0},
+        {ExecutionKind::TRIGGERED, 21, 0},
+        {ExecutionKind::FILLED, 22, 9970},
+        {ExecutionKind::FILLED, 23, 9970},
+        {ExecutionKind::FILLED, 21, 9950},
+        {ExecutionKind::TRIGGERED, 24, 0},
+        {ExecutionKind::FILLED, 24, 9950},
+    });
+
+    MarketData market = book.getMarketData();
+    CHECK(market.lastTrade == 9950);
+    CHECK(market.bidSize == 8);
+    // Below every trade, so still waiting
+    CHECK(book.cancel(25, CONSOLE_USER_ID));
+}
+
+// The mirror image: a trade at 10010 triggers the BUY stops at 10010 in
+// time order, then the one at 10005
+void buyOrder() {
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(64);
+    book.attachExecutionSink(&ring, 0);
+    book.match(makeOrder(1, OTHER_USER, OrderType::LIMIT, Side::SELL, 10010, 1));
+    book.match(makeOrder(2, OTHER_USER, OrderType::LIMIT, Side::SELL, 10030, 10));
+    book.match(makeStop(31, Side::BUY, 10005));
+    book.match(makeStop(32, Side::BUY, 10010));
+    book.match(makeStop(33, Side::BUY, 10010));
+    book.match(makeStop(34, Side::BUY, 10050));
+    drain(ring);
+
+    book.match(makeOrder(3, OTHER_USER, OrderType::MARKET, Side::BUY, 0, 1));
+    checkReports(drain(ring), {
+        {ExecutionKind::TRIGGERED, 32, 0},
+        {ExecutionKind::TRIGGERED, 33, 0},
+        {ExecutionKind::TRIGGERED, 31, 0},
+        {ExecutionKind::FILLED, 32, 10030},
+        {ExecutionKind::FILLED, 33, 10030},
+        {ExecutionKind::FILLED, 31, 10030},
+    });
+    CHECK(book.cancel(34, CONSOLE_USER_ID));
+}
+
+// A chain where every stop's trade triggers the next one runs to the end,
+// one stop at a time, without growing the stack per link
+void longChain() {
+    const int links = 20000;
+    const Price top = 30000;
+    OrderBook book;
+    SpscRing<ExecutionReport> ring(1 << 16);
+    book.attachExecutionSink(&ring, 0);
+    for (int i = 0; i <= links; ++i) {
+        book.match(makeOrder(1 + i, OTHER_USER, OrderType::LIMIT, Side::BUY, top - i, 1));
+    }
+    for (int i = 0; i < links; ++i) {
+        book.match(makeStop(100000 + i, Side::SELL, top - i));
+    }
+    drain(ring);
+
+    book.match(makeOrder(99999, OTHER_USER, OrderType::MARKET, Side::SELL, 0, 1));
+    std::vector<ExecutionReport> reports = drain(ring);
+    CHECK(reports.size() == 2 * static_cast<size_t>(links));
+    bool inOrder = true;
+    for (size_t i = 0; i + 1 < reports.size(); i += 2) {
+        int id = 100000 + static_cast<int>(i / 2);
+        inOrder = inOrder && reports[i].kind == ExecutionKind::TRIGGERED && reports[i].orderId == id &&
+                  reports[i + 1].kind == ExecutionKind::FILLED && reports[i + 1].orderId == id;
+    }
+    CHECK(inOrder);
+
+    MarketData market = book.getMarketData();
+    CHECK(market.lastTrade == top - links);
+    CHECK(!market.hasBid());
+}
+
+}  // namespace
+
+int main() {
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    sellCascade();
+    buyOrder();
+    longChain();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All stop cascade checks passed\n";
+    return 0;
+}
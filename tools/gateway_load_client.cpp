@@ -0,0 +1,234 @@
+// Drives OrderBookSimulator's order entry gateway (--gateway-shm NAME or
+// --gateway-socket PATH) from another process and reports how fast requests
+// went through and how long each took to be acknowledged.
+//
+//   GatewayLoadClient [--shm NAME | --socket PATH] [--orders N] [--window W]
+//                     [--symbols N] [--mid TICKS] [--seed N]
+//
+// Sends N requests, at most W of them unacknowledged at a time: limit
+// orders a few ticks either side of the mid, some priced through it so
+// they trade, a few market orders, and cancels of its own resting orders.
+// Each request's clientTag is the clock reading when it was sent, so the
+// round trip is measured from the ack alone. Defaults to /orderbook_gw.
+
+#include "gateway_client.hpp"
+#include "histogram.hpp"
+#include "order.hpp"
+#include "tsc_clock.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct LoadClientConfig {
+    std::string shmName = "/orderbook_gw";
+    std::string socketPath;
+    uint64_t orders = 1000000;
+    size_t window = 1024;
+    uint32_t symbols = 0;          // 0 = every symbol the gateway has
+    Price mid = 10000;
+    uint64_t seed = 1;
+};
+
+struct RestingOrder {
+    int32_t orderId;
+    SymbolId symbol;
+};
+
+class RequestSource {
+public:
+    RequestSource(const LoadClientConfig& config_, uint32_t symbolCount_)
+        : config(config_), symbolCount(symbolCount_), rng(config_.seed) {}
+
+    GatewayRequest next(std::vector<RestingOrder>& resting) {
+        GatewayRequest request{};
+        uint64_t draw = rng();
+        unsigned kind = static_cast<unsigned>(draw % 100);
+        request.symbol = static_cast<SymbolId>((draw >> 8) % symbolCount);
+        request.side = static_cast<uint8_t>((draw >> 20) & 1 ? Side::SELL : Side::BUY);
+        request.quantity = 1 + static_cast<Quantity>((draw >> 24) % 100);
+
+        if (kind < 25 && !resting.empty()) {
+            size_t pick = static_cast<size_t>((draw >> 32) % resting.size());
+            request.action = static_cast<uint8_t>(OrderAction::CANCEL);
+            request.orderId = resting[pick].orderId;
+            request.symbol = resting[pick].symbol;
+            resting[pick] = resting.back();
+            resting.pop_back();
+        } else if (kind < 30) {
+            request.action = static_cast<uint8_t>(OrderAction::NEW);
+            request.type = static_cast<uint8_t>(OrderType::MARKET);
+        } else {
+            // One in ten crosses the mid and trades with what rests there
+            Price offset = 1 + static_cast<Price>((draw >> 32) % 20);
+            bool through = kind >= 90;
+            bool buy = request.side == static_cast<uint8_t>(Side::BUY);
+            request.action = static_cast<uint8_t>(OrderAction::NEW);
+            request.type = static_cast<uint8_t>(OrderType::LIMIT);
+            request.price = (buy != through) ? config.mid - offset : config.mid + offset;
+        }
+        return request;
+    }
+
+private:
+    const LoadClientConfig& config;
+    uint32_t symbolCount;
+    std::mt19937_64 rng;
+};
+
+double micros(uint64_t ticks) {
+    return TscClock::toNanos(ticks) / 1000.0;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --shm NAME      Gateway shared memory to connect to (default /orderbook_gw)\n"
+              << "  --socket PATH   Connect to the gateway's Unix domain socket instead\n"
+              << "  --orders N      Requests to send (default 1000000)\n"
+              << "  --window W      Requests in flight at most (default 1024)\n"
+              << "  --symbols N     Trade the first N symbols (default all)\n"
+              << "  --mid TICKS     Price orders around this many ticks (default 10000)\n"
+              << "  --seed N        Seed of the request mix (default 1)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    LoadClientConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) {
+            config.shmName = argv[++i];
+        } else if (arg == "--socket" && i + 1 < argc) {
+            config.socketPath = argv[++i];
+        } else if (arg == "--orders" && i + 1 < argc) {
+            config.orders = std::stoull(argv[++i]);
+        } else if (arg == "--window" && i + 1 < argc) {
+            config.window = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--symbols" && i + 1 < argc) {
+            config.symbols = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--mid" && i + 1 < argc) {
+            config.mid = std::stoll(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    GatewayClient client;
+    std::string error;
+    bool connected = config.socketPath.empty() ? client.connectShm(config.shmName, error)
+                                               : client.connectSocket(config.socketPath, error);
+    if (!connected) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    uint32_t symbolCount = client.getSymbolCount();
+    if (config.symbols > 0) {
+        symbolCount = std::min(symbolCount, config.symbols);
+    }
+    std::cout << "Connected to " << (config.socketPath.empty() ? config.shmName : config.socketPath)
+              << " as user " << client.getUserId() << ", " << symbolCount << " symbol(s)\n";
+
+    RequestSource source(config, std::max<uint32_t>(1, symbolCount));
+    std::vector<RestingOrder> resting;
+    std::vector<GatewayRequest> pending;
+    std::vector<GatewayResponse> responses(4096);
+    auto roundTrip = std::make_unique<LatencyHistogram>();
+
+    uint64_t sent = 0;
+    uint64_t answered = 0;
+    uint64_t accepted = 0;
+    uint64_t rejected = 0;
+    uint64_t fills = 0;
+    Quantity filledQuantity = 0;
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto lastProgress = start;
+
+    while (answered < config.orders && client.isConnected()) {
+        // Top the window up, sending whatever the ring takes in one go
+        if (pending.empty() && sent < config.orders && sent - answered < config.window) {
+            size_t count = std::min<uint64_t>(config.window - (sent - answered), config.orders - sent);
+            for (size_t i = 0; i < count; ++i) {
+                pending.push_back(source.next(resting));
+            }
+        }
+        if (!pending.empty()) {
+            Ticks now = TscClock::now();
+            for (GatewayRequest& request : pending) {
+                request.clientTag = now;
+            }
+            size_t taken = client.send(pending.data(), pending.size());
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(taken));
+            sent += taken;
+        }
+
+        size_t count = client.poll(responses.data(), responses.size());
+        if (count == 0) {
+            if (!pending.empty() || sent - answered >= config.window) {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        Ticks now = TscClock::now();
+        for (size_t i = 0; i < count; ++i) {
+            const GatewayResponse& response = responses[i];
+            if (response.kind == GatewayResponseKind::FILL) {
+                ++fills;
+                filledQuantity += response.quantity;
+                continue;
+            }
+            ++answered;
+            roundTrip->record(TscClock::elapsed(response.clientTag, now));
+            if (response.kind == GatewayResponseKind::REJECTED) {
+                ++rejected;
+                continue;
+            }
+            ++accepted;
+            if (response.action == static_cast<uint8_t>(OrderAction::NEW) && resting.size() < 100000) {
+                resting.push_back(RestingOrder{response.orderId, response.symbol});
+            }
+        }
+
+        auto wall = Clock::now();
+        if (wall - lastProgress >= std::chrono::seconds(1)) {
+            std::cout << "  " << answered << " / " << config.orders << " acknowledged\n";
+            lastProgress = wall;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    HistogramSnapshot latency;
+    roundTrip->addTo(latency);
+    std::cout << std::fixed << std::setprecision(0)
+              << "Sent " << sent << " requests in " << std::setprecision(2) << seconds << "s: "
+              << std::setprecision(0) << static_cast<double>(answered) / seconds << " requests/sec\n"
+              << "Accepted " << accepted << ", rejected " << rejected << ", fills " << fills
+              << " (" << filledQuantity << " lots)";
+    if (client.getResponsesDropped() > 0) {
+        std::cout << ", " << client.getResponsesDropped() << " responses dropped by the gateway";
+    }
+    std::cout << "\n";
+    if (latency.count > 0) {
+        std::cout << std::setprecision(2) << "Round trip (us): p50 " << micros(latency.valueAt(0.50))
+                  << "  p99 " << micros(latency.valueAt(0.99)) << "  p99.9 " << micros(latency.valueAt(0.999))
+                  << "  max " << micros(latency.max()) << "\n";
+    }
+    if (!client.isConnected()) {
+        std::cout << "The gateway ended the session before every request was acknowledged\n";
+        return 1;
+    }
+    return 0;
+}
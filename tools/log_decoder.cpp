@@ -0,0 +1,108 @@
+// Turns a binary event log written with --log-format binary back into the
+// orders.log / matches.log CSV files the text logger produces.
+//
+//   OrderLogDecoder [input.bin] [output-dir]
+//
+// Defaults to logs/events.bin and logs/decoded. Output files are overwritten.
+
+#include "log_record.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    std::string inputPath = argc > 1 ? argv[1] : "logs/events.bin";
+    std::string outputDir = argc > 2 ? argv[2] : "logs/decoded";
+
+    if (inputPath == "--help" || inputPath == "-h") {
+        std::cout << "Usage: " << argv[0] << " [input.bin] [output-dir]\n";
+        return 0;
+    }
+
+    std::ifstream input(inputPath, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Could not open " << inputPath << "\n";
+        return 1;
+    }
+
+    try {
+        std::filesystem::create_directories(outputDir);
+    } catch (const std::exception& e) {
+        std::cerr << "Could not create " << outputDir << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    std::ofstream ordersFile(outputDir + "/orders.log", std::ios::trunc);
+    std::ofstream matchesFile(outputDir + "/matches.log", std::ios::trunc);
+    if (!ordersFile.is_open() || !matchesFile.is_open()) {
+        std::cerr << "Could not open output files in " << outputDir << "\n";
+        return 1;
+    }
+    ordersFile << ORDERS_CSV_HEADER;
+    matchesFile << MATCHES_CSV_HEADER;
+
+    std::vector<Instrument> instruments;
+    long segments = 0, orders = 0, matches = 0, skipped = 0;
+    char buffer[LOG_RECORD_SIZE];
+
+    while (input.read(buffer, sizeof(buffer))) {
+        LogRecordKind kind = static_cast<LogRecordKind>(buffer[0]);
+
+        switch (kind) {
+            case LogRecordKind::SEGMENT: {
+                LogSegmentRecord segment;
+                std::memcpy(&segment, buffer, sizeof(segment));
+                if (segment.magic != LOG_SEGMENT_MAGIC || segment.version != LOG_FORMAT_VERSION) {
+                    std::cerr << "Unsupported log segment at record " << (segments + orders + matches + skipped) << "\n";
+                    return 1;
+                }
+                instruments.assign(segment.instrumentCount, Instrument{});
+                ++segments;
+                break;
+            }
+            case LogRecordKind::INSTRUMENT: {
+                LogInstrumentRecord record;
+                std::memcpy(&record, buffer, sizeof(record));
+                if (record.symbol < instruments.size()) {
+                    instruments[record.symbol] = instrumentFromRecord(record);
+                }
+                break;
+            }
+            case LogRecordKind::ORDER:
+            case LogRecordKind::MATCH: {
+                LogRecord record;
+                std::memcpy(&record, buffer, sizeof(record));
+                if (record.symbol >= instruments.size()) {
+                    ++skipped;
+                    break;
+                }
+                if (kind == LogRecordKind::ORDER) {
+                    writeOrderCsv(ordersFile, record, instruments[record.symbol]);
+                    ++orders;
+                } else {
+                    writeMatchCsv(matchesFile, record, instruments[record.symbol]);
+                    ++matches;
+                }
+                break;
+            }
+            default:
+                ++skipped;
+                break;
+        }
+    }
+
+    if (input.gcount() != 0) {
+        std::cerr << "Warning: ignored a truncated record at the end of " << inputPath << "\n";
+    }
+
+    std::cout << "Decoded " << segments << " run(s): " << orders << " order records, "
+              << matches << " match records";
+    if (skipped > 0) {
+        std::cout << ", " << skipped << " skipped";
+    }
+    std::cout << " -> " << outputDir << "\n";
+    return 0;
+}
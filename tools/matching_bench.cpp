@@ -0,0 +1,443 @@
+// Drives OrderBook directly through fixed matching scenarios, with no UI,
+// engine threads or logging, and reports per-operation latency.
+//
+//   MatchingBenchmark [--scenario NAME|all] [--ops N] [--seed N]
+//                     [--book-backend map|ladder] [--json PATH]
+//
+// Every scenario is generated from the seed before it is timed, so two runs
+// with the same seed feed the book exactly the same requests. Build with
+// -DORDERBOOK_BENCHMARKS=OFF to keep the simulator's own timers out of the
+// numbers when comparing builds.
+
+#include "order_book.hpp"
+#include "histogram.hpp"
+#include "logger.hpp"
+#include "benchmark.hpp"
+#include "tsc_clock.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const Price MID = 10000;        // 100.00 at the default tick size
+const int BENCH_USER = 1001;    // Any user but the console's, so the book reports nothing
+
+struct ScenarioConfig {
+    size_t ops = 100000;
+    uint64_t seed = 42;
+    BookConfig book;
+};
+
+struct ScenarioResult {
+    std::string name;
+    std::string unit;           // What one timed operation is
+    HistogramSnapshot latency;  // Ticks per operation
+};
+
+// One timed operation per call; setup outside `run` is not measured
+class Recorder {
+public:
+    template <typename F>
+    void time(F&& run) {
+        Ticks start = TscClock::now();
+        run();
+        histogram.record(TscClock::elapsed(start, TscClock::nowOrdered()));
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot result;
+        histogram.addTo(result);
+        return result;
+    }
+
+private:
+    LatencyHistogram histogram;
+};
+
+Order makeOrder(int id, OrderType type, Side side, Price price, Quantity quantity) {
+    Order order;
+    order.id = id;
+    order.userId = BENCH_USER;
+    order.type = type;
+    order.side = side;
+    order.price = price;
+    order.quantity = quantity;
+    return order;
+}
+
+// Same dispatch a shard does for a sequenced request
+void apply(OrderBook& book, const Order& order) {
+    switch (order.action) {
+        case OrderAction::NEW: book.match(order); break;
+        case OrderAction::CANCEL: book.cancel(order.id, order.userId); break;
+        case OrderAction::MODIFY: book.modify(order.id, order.userId, order.price, order.quantity); break;
+        case OrderAction::SNAPSHOT: break;
+    }
+}
+
+// Non-crossing limit orders into an empty book: bids below the mid, asks above
+ScenarioResult addOnly(const ScenarioConfig& config) {
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<Price> offset(1, 500);
+    std::uniform_int_distribution<Quantity> lots(1, 1000);
+
+    std::vector<Order> orders;
+    orders.reserve(config.ops);
+    for (size_t i = 0; i < config.ops; ++i) {
+        Side side = (i % 2 == 0) ? Side::BUY : Side::SELL;
+        Price price = (side == Side::BUY) ? MID - offset(rng) : MID + offset(rng);
+        orders.push_back(makeOrder(static_cast<int>(i + 1), OrderType::LIMIT, side, price, lots(rng)));
+    }
+
+    OrderBook book(Instrument{}, config.book);
+    Recorder recorder;
+    for (const Order& order : orders) {
+        recorder.time([&] { book.match(order); });
+    }
+    return {"add_only", "order", recorder.snapshot()};
+}
+
+// A buy limit that clears `levels` ask levels of `perLevel` orders each
+ScenarioResult sweep(const ScenarioConfig& config, int levels, int perLevel) {
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<Quantity> lots(1, 100);
+
+    size_t sweeps = std::max<size_t>(1, config.ops / static_cast<size_t>(levels * perLevel));
+    OrderBook book(Instrument{}, config.book);
+    Recorder recorder;
+    int nextId = 1;
+
+    for (size_t s = 0; s < sweeps; ++s) {
+        Quantity total = 0;
+        for (int level = 0; level < levels; ++level) {
+            for (int k = 0; k < perLevel; ++k) {
+                Quantity quantity = lots(rng);
+                total += quantity;
+                book.match(makeOrder(nextId++, OrderType::LIMIT, Side::SELL, MID + 1 + level, quantity));
+            }
+        }
+        Order sweeper = makeOrder(nextId++, OrderType::LIMIT, Side::BUY, MID + levels, total);
+        recorder.time([&] { book.match(sweeper); });
+    }
+    return {"sweep_" + std::to_string(levels) + "_levels", "sweep", recorder.snapshot()};
+}
+
+// Small market orders from both sides against a deep two-sided book, which is
+// topped back up between orders
+ScenarioResult marketDeep(const ScenarioConfig& config) {
+    const int depth = 1000;
+    const int perLevel = 4;
+    const Quantity restingLots = 100;
+
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<Quantity> lots(1, 2 * restingLots);
+    std::uniform_int_distribution<int> sideRoll(0, 1);
+
+    OrderBook book(Instrument{}, config.book);
+    int nextId = 1;
+    for (int level = 0; level < depth; ++level) {
+        for (int k = 0; k < perLevel; ++k) {
+            book.match(makeOrder(nextId++, OrderType::LIMIT, Side::BUY, MID - 1 - level, restingLots));
+            book.match(makeOrder(nextId++, OrderType::LIMIT, Side::SELL, MID + 1 + level, restingLots));
+        }
+    }
+
+    Recorder recorder;
+    for (size_t i = 0; i < config.ops; ++i) {
+        Side side = sideRoll(rng) ? Side::BUY : Side::SELL;
+        Quantity quantity = lots(rng);
+        Order order = makeOrder(nextId++, OrderType::MARKET, side, 0, quantity);
+        recorder.time([&] { book.match(order); });
+
+        // Put back what was taken, at the far end so the top keeps thinning
+        Side refillSide = (side == Side::BUY) ? Side::SELL : Side::BUY;
+        Price farPrice = (refillSide == Side::SELL) ? MID + depth : MID - depth;
+        book.match(makeOrder(nextId++, OrderType::LIMIT, refillSide, farPrice, quantity));
+    }
+    return {"market_deep_book", "order", recorder.snapshot()};
+}
+
+// Buys that each take ten display slices from a level of resting icebergs,
+// so every order fills and refills ten slices. A refill tops up the filled
+// node in place and requeues it at the back of the level, so this measures
+// the fill, the in-place refill and the requeue, with no lookup.
+ScenarioResult icebergRefill(const ScenarioConfig& config) {
+    const Quantity display = 10;
+    const Quantity slicesPerOrder = 10;
+
+    OrderBook book(Instrument{}, config.book);
+    int nextId = 1;
+    Order iceberg = makeOrder(nextId++, OrderType::ICEBERG, Side::SELL, MID + 1, 0);
+    iceberg.displayQuantity = display;
+    iceberg.totalQuantity = static_cast<Quantity>(config.ops + 1) * display * slicesPerOrder;
+    iceberg.quantity = iceberg.totalQuantity;
+    book.match(iceberg);
+
+    // Other icebergs at the same price: slices rotate through them, and a
+    // refill should cost the same however many there are
+    for (int i = 0; i < 64; ++i) {
+        Order other = makeOrder(nextId++, OrderType::ICEBERG, Side::SELL, MID + 1, 0);
+        other.displayQuantity = display;
+        other.totalQuantity = display * 1000;
+        other.quantity = other.totalQuantity;
+        book.match(other);
+    }
+
+    Recorder recorder;
+    for (size_t i = 0; i < config.ops; ++i) {
+        Order taker = makeOrder(nextId++, OrderType::LIMIT, Side::BUY, MID + 1, display * slicesPerOrder);
+        recorder.time([&] { book.match(taker); });
+    }
+    return {"iceberg_refill_storm", "order", recorder.snapshot()};
+}
+
+// One trade that sets off a chain of `chain` STOP_MARKET sells, each of which
+// trades one tick lower and triggers the next
+ScenarioResult stopCascade(const ScenarioConfig& config, int chain) {
+    size_t cascades = std::max<size_t>(1, config.ops / static_cast<size_t>(chain));
+    OrderBook book(Instrument{}, config.book);
+    Recorder recorder;
+    int nextId = 1;
+
+    for (size_t c = 0; c < cascades; ++c) {
+        for (int i = 0; i <= chain; ++i) {
+            book.match(makeOrder(nextId++, OrderType::LIMIT, Side::BUY, MID - i, 1));
+        }
+        for (int i = 0; i < chain; ++i) {
+            Order stop = makeOrder(nextId++, OrderType::STOP_MARKET, Side::SELL, 0, 1);
+            stop.triggerPrice = MID - i;
+            book.match(stop);
+        }
+        Order trigger = makeOrder(nextId++, OrderType::LIMIT, Side::SELL, MID, 1);
+        recorder.time([&] { book.match(trigger); });
+    }
+    return {"stop_cascade_" + std::to_string(chain), "cascade", recorder.snapshot()};
+}
+
+// Mostly limits around the mid, with market, STOP and ICEBERG orders and
+// cancels and modifies of earlier orders mixed in
+ScenarioResult mixedFlow(const ScenarioConfig& config) {
+    std::mt19937_64 rng(config.seed);
+    std::uniform_int_distribution<int> roll(0, 99);
+    std::uniform_int_distribution<int> sideRoll(0, 1);
+    std::normal_distribution<double> offset(0.0, 20.0);
+    std::uniform_int_distribution<Quantity> lots(1, 500);
+
+    std::vector<Order> requests;
+    requests.reserve(config.ops);
+    std::vector<int> placed;
+    int nextId = 1;
+
+    for (size_t i = 0; i < config.ops; ++i) {
+        int r = roll(rng);
+        Side side = sideRoll(rng) ? Side::BUY : Side::SELL;
+        Price price = MID + static_cast<Price>(offset(rng));
+        Quantity quantity = lots(rng);
+
+        if (r < 18 && !placed.empty()) {
+            Order request = makeOrder(placed[std::uniform_int_distribution<size_t>(0, placed.size() - 1)(rng)],
+                                      OrderType::LIMIT, side, price, quantity);
+            request.action = (r < 12) ? OrderAction::CANCEL : OrderAction::MODIFY;
+            requests.push_back(request);
+            continue;
+        }
+
+        Order order = makeOrder(nextId++, OrderType::LIMIT, side, price, quantity);
+        if (r < 30) {
+            order.type = OrderType::MARKET;
+            order.price = 0;
+        } else if (r < 35) {
+            order.type = OrderType::STOP_MARKET;
+            order.price = 0;
+            order.triggerPrice = (side == Side::SELL) ? MID - 40 : MID + 40;
+        } else if (r < 40) {
+            order.type = OrderType::ICEBERG;
+            order.displayQuantity = quantity;
+            order.totalQuantity = quantity * 5;
+            order.quantity = order.totalQuantity;
+        }
+        if (order.type == OrderType::LIMIT || order.type == OrderType::ICEBERG) {
+            placed.push_back(order.id);
+        }
+        requests.push_back(order);
+    }
+
+    OrderBook book(Instrument{}, config.book);
+    Recorder recorder;
+    for (const Order& request : requests) {
+        recorder.time([&] { apply(book, request); });
+    }
+    return {"mixed_flow", "request", recorder.snapshot()};
+}
+
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+const char* const QUANTILE_LABELS[] = {"p50", "p90", "p99", "p99_9"};
+
+double nanos(uint64_t ticks) {
+    return TscClock::toNanos(ticks);
+}
+
+double opsPerSecond(const HistogramSnapshot& latency) {
+    double totalNanos = nanos(latency.sum);
+    return totalNanos > 0 ? static_cast<double>(latency.count) * 1e9 / totalNanos : 0.0;
+}
+
+void printTable(const std::vector<ScenarioResult>& results) {
+    std::cout << std::left << std::setw(24) << "Scenario" << std::right
+              << std::setw(10) << "Ops" << std::setw(12) << "ns/op" << std::setw(14) << "ops/sec";
+    for (const char* label : QUANTILE_LABELS) {
+        std::cout << std::setw(11) << label;
+    }
+    std::cout << std::setw(11) << "max" << "\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const ScenarioResult& result : results) {
+        const HistogramSnapshot& latency = result.latency;
+        std::cout << std::left << std::setw(24) << result.name << std::right
+                  << std::setw(10) << latency.count
+                  << std::setw(12) << nanos(static_cast<uint64_t>(latency.mean()))
+                  << std::setw(14) << opsPerSecond(latency);
+        for (double quantile : QUANTILES) {
+            std::cout << std::setw(11) << nanos(latency.valueAt(quantile));
+        }
+        std::cout << std::setw(11) << nanos(latency.max()) << "\n";
+    }
+}
+
+bool writeJson(const std::string& path, const std::vector<ScenarioResult>& results, const ScenarioConfig& config) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(1);
+    file << "{\n"
+         << "  \"clock\": \"" << (TscClock::usesTsc() ? "tsc" : "steady_clock") << "\",\n"
+         << "  \"backend\": \"" << (config.book.backend == BookBackend::MAP ? "map" : "ladder") << "\",\n"
+         << "  \"seed\": " << config.seed << ",\n"
+         << "  \"ops\": " << config.ops << ",\n"
+         << "  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScenarioResult& result = results[i];
+        const HistogramSnapshot& latency = result.latency;
+        file << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\""
+             << ", \"count\": " << latency.count
+             << ", \"ns_per_op\": " << nanos(static_cast<uint64_t>(latency.mean()))
+             << ", \"ops_per_sec\": " << opsPerSecond(latency);
+        for (size_t q = 0; q < sizeof(QUANTILES) / sizeof(QUANTILES[0]); ++q) {
+            file << ", \"" << QUANTILE_LABELS[q] << "_ns\": " << nanos(latency.valueAt(QUANTILES[q]));
+        }
+        file << ", \"max_ns\": " << nanos(latency.max()) << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+    return true;
+}
+
+struct Scenario {
+    const char* name;
+    std::function<ScenarioResult(const ScenarioConfig&)> run;
+};
+
+void printUsage(const char* program, const std::vector<Scenario>& scenarios) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --scenario NAME|all         Scenario to run (default all)\n"
+              << "  --ops N                     Timed operations per scenario, roughly (default 100000)\n"
+              << "  --seed N                    Seed for generated order flow (default 42)\n"
+              << "  --book-backend map|ladder   Price level storage (default from build)\n"
+              << "  --json PATH                 Also write the results to PATH as JSON\n"
+              << "Scenarios:";
+    for (const Scenario& scenario : scenarios) {
+        std::cerr << " " << scenario.name;
+    }
+    std::cerr << "\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const std::vector<Scenario> scenarios = {
+        {"add_only", addOnly},
+        {"sweep_1", [](const ScenarioConfig& c) { return sweep(c, 1, 4); }},
+        {"sweep_10", [](const ScenarioConfig& c) { return sweep(c, 10, 4); }},
+        {"sweep_100", [](const ScenarioConfig& c) { return sweep(c, 100, 4); }},
+        {"market_deep", marketDeep},
+        {"iceberg_refill", icebergRefill},
+        {"stop_cascade", [](const ScenarioConfig& c) { return stopCascade(c, 32); }},
+        {"mixed", mixedFlow},
+    };
+
+    ScenarioConfig config;
+    std::string selected = "all";
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scenario" && i + 1 < argc) {
+            selected = argv[++i];
+        } else if (arg == "--ops" && i + 1 < argc) {
+            config.ops = std::stoull(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--book-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "map") {
+                config.book.backend = BookBackend::MAP;
+            } else if (backend == "ladder") {
+                config.book.backend = BookBackend::LADDER;
+            } else {
+                std::cerr << "Unknown book backend '" << backend << "', expected 'map' or 'ladder'\n";
+                return 1;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            printUsage(argv[0], scenarios);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    // Only the book is measured: no CSV files and no benchmarks.log
+    Logger::getInstance().setEnabled(false);
+    Benchmark::getInstance().enableLogging(false);
+
+    std::vector<ScenarioResult> results;
+    for (const Scenario& scenario : scenarios) {
+        if (selected != "all" && selected != scenario.name) {
+            continue;
+        }
+        // A short untimed pass first, so page faults and cold caches from
+        // the first pool allocations don't land in the numbers
+        ScenarioConfig warmup = config;
+        warmup.ops = std::max<size_t>(1, config.ops / 10);
+        scenario.run(warmup);
+
+        results.push_back(scenario.run(config));
+    }
+
+    if (results.empty()) {
+        std::cerr << "Unknown scenario '" << selected << "'\n";
+        printUsage(argv[0], scenarios);
+        return 1;
+    }
+
+    std::cout << "Clock: " << (TscClock::usesTsc() ? "TSC" : "steady_clock")
+              << ", backend: " << (config.book.backend == BookBackend::MAP ? "map" : "ladder")
+              << ", seed: " << config.seed << " (latencies in ns)\n";
+    printTable(results);
+
+    if (!jsonPath.empty()) {
+        if (!writeJson(jsonPath, results, config)) {
+            std::cerr << "Could not write " << jsonPath << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << jsonPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Reads the shared memory market data feed written by OrderBookSimulator
+// --md-shm NAME and reports, once a second, how many messages and trades
+// arrived, how many were lost to being lapped, and the latency from the
+// publisher writing a message to this process reading it.
+//
+//   MarketDataSubscriber [--shm NAME] [--seconds N] [--wait S]
+//
+// Defaults to /orderbook_md, runs until the publisher shuts down, and waits
+// up to 10 seconds for the feed to appear. Any number of subscribers can
+// read the same feed; none of them slows the publisher down.
+
+#include "shm_feed.hpp"
+#include "histogram.hpp"
+#include "tsc_clock.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct Interval {
+    uint64_t messages = 0;
+    uint64_t trades = 0;
+    uint64_t lost = 0;
+    LatencyHistogram latency;   // Ticks from publish to read
+};
+
+double micros(uint64_t ticks) {
+    return TscClock::toNanos(ticks) / 1000.0;
+}
+
+void printRow(double seconds, const Interval& interval, bool timed) {
+    HistogramSnapshot latency;
+    interval.latency.addTo(latency);
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(8) << seconds
+              << std::setw(14) << static_cast<double>(interval.messages) / seconds
+              << std::setw(12) << static_cast<double>(interval.trades) / seconds
+              << std::setw(10) << interval.lost;
+    if (timed && latency.count > 0) {
+        std::cout << std::setprecision(2)
+                  << std::setw(11) << micros(latency.valueAt(0.50))
+                  << std::setw(11) << micros(latency.valueAt(0.99))
+                  << std::setw(11) << micros(latency.valueAt(0.999))
+                  << std::setw(11) << micros(latency.max());
+    }
+    std::cout << "\n";
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --shm NAME      Feed to read (default /orderbook_md)\n"
+              << "  --seconds N     Stop after N seconds (default: when the publisher stops)\n"
+              << "  --wait S        Seconds to wait for the feed to appear (default 10)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = "/orderbook_md";
+    double seconds = 0.0;
+    double waitSeconds = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--shm" && i + 1 < argc) {
+            name = argv[++i];
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::stod(argv[++i]);
+        } else if (arg == "--wait" && i + 1 < argc) {
+            waitSeconds = std::stod(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    ShmSubscriber subscriber;
+    std::string error;
+    auto waitUntil = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(waitSeconds));
+    while (!subscriber.open(name, error)) {
+        if (Clock::now() >= waitUntil) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // Stamps are only comparable if both processes read the same clock
+    const ShmFeedHeader& header = subscriber.getHeader();
+    bool timed = (header.usesTsc != 0) == TscClock::usesTsc();
+    std::cout << "Reading " << name << " (" << header.capacity << " slots, " << header.symbolCount << " symbols)\n";
+    if (!timed) {
+        std::cout << "Publisher uses a different clock; latency is not reported\n";
+    }
+    std::cout << std::setw(8) << "Sec" << std::setw(14) << "Msgs/sec" << std::setw(12) << "Trades/sec"
+              << std::setw(10) << "Lost";
+    if (timed) {
+        std::cout << std::setw(11) << "p50(us)" << std::setw(11) << "p99(us)" << std::setw(11) << "p99.9(us)"
+                  << std::setw(11) << "Max(us)";
+    }
+    std::cout << "\n";
+
+    auto start = Clock::now();
+    auto intervalStart = start;
+    auto interval = std::make_unique<Interval>();
+    uint64_t totalMessages = 0;
+    uint64_t lostBefore = 0;
+    uint64_t polls = 0;
+    unsigned idlePolls = 0;
+    bool closed = false;
+
+    while (!closed) {
+        ShmFeedMessage message;
+        ShmSubscriber::ReadStatus status = subscriber.poll(message);
+        if (status == ShmSubscriber::ReadStatus::MESSAGE) {
+            ++interval->messages;
+            if (message.kind == DepthUpdateKind::TRADE) {
+                ++interval->trades;
+            }
+            interval->latency.record(TscClock::elapsed(message.published, TscClock::now()));
+            idlePolls = 0;
+        } else if (status == ShmSubscriber::ReadStatus::CLOSED) {
+            closed = true;
+        } else if (status == ShmSubscriber::ReadStatus::EMPTY && ++idlePolls > 1000) {
+            std::this_thread::yield();
+        }
+
+        // A busy feed is read in a tight loop; the clock is checked every
+        // so often rather than per message
+        if (status == ShmSubscriber::ReadStatus::MESSAGE && (++polls & 1023) != 0) {
+            continue;
+        }
+        auto now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - intervalStart).count();
+        if (elapsed >= 1.0 || closed) {
+            interval->lost = subscriber.getLostMessages() - lostBefore;
+            lostBefore = subscriber.getLostMessages();
+            printRow(elapsed, *interval, timed);
+            totalMessages += interval->messages;
+            interval = std::make_unique<Interval>();
+            intervalStart = now;
+        }
+        if (seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= seconds) {
+            totalMessages += interval->messages;
+            break;
+        }
+    }
+
+    std::cout << "Read " << totalMessages << " messages, lost " << subscriber.getLostMessages() << " to laps"
+              << (closed ? "; publisher closed the feed" : "") << "\n";
+    return 0;
+}